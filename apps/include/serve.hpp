@@ -0,0 +1,403 @@
+#ifndef SERVE_HPP
+#define SERVE_HPP
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <CLI/App.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <hyper_grasp.hpp>
+#include <iostream>
+#include <memory>
+#include <mokp.hpp>
+#include <momst.hpp>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+// `hyper-grasp serve`: keeps parsed instances in memory and solves requests
+// received over a UNIX domain socket on a shared pool of workers.
+//
+// The protocol is line based. A request is one line of key=value pairs:
+//   id=7 problem=mokp file=instances/mokp/random/2D/100_1.in maximization=true alpha=0.1 time=1 seed=3
+// Keys: id, problem (mokp|momst), file, bound (dantzig|mt), maximization
+// (defaults to the sense of the problem: true for mokp, false for momst),
+// local_search, alpha, time (seconds) or iterations, seed. A connection may
+// send many requests without waiting; each is answered when it finishes:
+//   solution id=7 <objective values>      (one line per archive solution)
+//   done id=7 solutions=<n> hv=<hv> iterations=<n> time=<seconds>
+// or `error id=7 <message>`.
+namespace serve {
+
+struct SolveRequest {
+  std::string id;
+  std::string problem = "mokp";
+  std::string file;
+  std::string bound = "dantzig";
+  bool is_maximization = true;
+  bool local_search = true;
+  double alpha = 0.05;
+  double time = 0;
+  int iterations = 0;
+  int64_t seed = 0;
+};
+
+inline bool parse_bool(const std::string& value) {
+  if (value == "true" || value == "1") return true;
+  if (value == "false" || value == "0") return false;
+  throw std::invalid_argument("Invalid boolean: " + value);
+}
+
+inline SolveRequest parse_request(const std::string& line) {
+  SolveRequest request;
+  request.seed = std::time(0);
+  bool has_maximization = false;
+  std::istringstream tokens(line);
+  std::string token;
+  while (tokens >> token) {
+    const auto eq = token.find('=');
+    if (eq == std::string::npos) {
+      throw std::invalid_argument("Expected key=value: " + token);
+    }
+    const std::string key = token.substr(0, eq);
+    const std::string value = token.substr(eq + 1);
+    if (key == "id") {
+      request.id = value;
+    } else if (key == "problem") {
+      request.problem = value;
+    } else if (key == "file") {
+      request.file = value;
+    } else if (key == "bound") {
+      request.bound = value;
+    } else if (key == "maximization") {
+      request.is_maximization = parse_bool(value);
+      has_maximization = true;
+    } else if (key == "local_search") {
+      request.local_search = parse_bool(value);
+    } else if (key == "alpha") {
+      request.alpha = std::stod(value);
+    } else if (key == "time") {
+      request.time = std::stod(value);
+    } else if (key == "iterations") {
+      request.iterations = std::stoi(value);
+    } else if (key == "seed") {
+      request.seed = std::stoll(value);
+    } else {
+      throw std::invalid_argument("Unknown key: " + key);
+    }
+  }
+  if (request.problem != "mokp" && request.problem != "momst") {
+    throw std::invalid_argument("Invalid problem: " + request.problem);
+  }
+  if (!has_maximization) {
+    request.is_maximization = request.problem == "mokp";
+  }
+  if (request.bound != "dantzig" && request.bound != "mt") {
+    throw std::invalid_argument("Invalid bound: " + request.bound);
+  }
+  if (request.file.empty()) {
+    throw std::invalid_argument("Missing file");
+  }
+  if (request.alpha < 0.0 || request.alpha > 1.0) {
+    throw std::invalid_argument("alpha must be between 0 and 1");
+  }
+  if ((request.time > 0) == (request.iterations > 0)) {
+    throw std::invalid_argument("Exactly one of time and iterations must be positive");
+  }
+  return request;
+}
+
+// Parsed and preprocessed instances, keyed by file path and content hash so
+// that an edited file is parsed again. Solves copy the cached problem, the
+// copies share the preprocessed MOKP item orders.
+class InstanceCache {
+ public:
+  using Instance = std::variant<MOKP<Solution, Candidate>, MOMST<Solution, Candidate>>;
+
+  std::shared_ptr<const Instance> get(const SolveRequest& request) {
+    std::ifstream file(request.file, std::ios::binary);
+    if (!file) {
+      throw std::invalid_argument("Cannot open " + request.file);
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    const std::string text = contents.str();
+    const std::string key = request.problem + ":" + request.bound + ":" + request.file + ":" +
+                            std::to_string(std::hash<std::string>()(text));
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = instances.find(key);
+      if (it != instances.end()) {
+        return it->second;
+      }
+    }
+    // Parsed outside the lock, two concurrent misses may both parse
+    std::shared_ptr<const Instance> instance;
+    if (request.problem == "mokp") {
+      const BoundType bound = request.bound == "mt" ? BoundType::MartelloToth : BoundType::Dantzig;
+      instance = std::make_shared<const Instance>(MOKP<Solution, Candidate>::from_stream(std::istringstream(text), bound));
+    } else {
+      instance = std::make_shared<const Instance>(MOMST<Solution, Candidate>::from_stream(std::istringstream(text)));
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    return instances.emplace(key, instance).first->second;
+  }
+
+ private:
+  std::mutex mutex;
+  std::unordered_map<std::string, std::shared_ptr<const Instance>> instances;
+};
+
+// Fixed number of threads that run jobs in submission order
+class WorkerPool {
+ public:
+  explicit WorkerPool(std::size_t n_workers) {
+    for (std::size_t i = 0; i < n_workers; ++i) {
+      workers.emplace_back([this] { run(); });
+    }
+  }
+
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    ready.notify_all();
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+
+  void submit(std::function<void()> job) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      jobs.push_back(std::move(job));
+    }
+    ready.notify_one();
+  }
+
+ private:
+  std::mutex mutex;
+  std::condition_variable ready;
+  std::deque<std::function<void()>> jobs;
+  std::vector<std::thread> workers;
+  bool stopping = false;
+
+  void run() {
+    while (true) {
+      std::function<void()> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty()) {
+          return;
+        }
+        job = std::move(jobs.front());
+        jobs.pop_front();
+      }
+      job();
+    }
+  }
+};
+
+// Client connection, closed when the reader and every pending job are done
+class Connection {
+ public:
+  explicit Connection(int fd) : fd(fd) {}
+  Connection(const Connection&) = delete;
+  Connection& operator=(const Connection&) = delete;
+
+  ~Connection() {
+    close(fd);
+  }
+
+  // Make a blocked read_line return, the pending responses are still sent
+  void stop_reading() {
+    shutdown(fd, SHUT_RD);
+  }
+
+  // Read one line, false at the end of the stream
+  bool read_line(std::string& line) {
+    while (true) {
+      const auto end = buffer.find('\n');
+      if (end != std::string::npos) {
+        line = buffer.substr(0, end);
+        buffer.erase(0, end + 1);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        return true;
+      }
+      char chunk[4096];
+      const ssize_t n = read(fd, chunk, sizeof(chunk));
+      if (n <= 0) {
+        if (buffer.empty()) return false;
+        line = std::move(buffer);
+        buffer.clear();
+        return true;
+      }
+      buffer.append(chunk, n);
+    }
+  }
+
+  // Responses of concurrent jobs are written whole, one at a time
+  void write_response(const std::string& response) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t written = 0;
+    while (written < response.size()) {
+      const ssize_t n = send(fd, response.data() + written, response.size() - written, MSG_NOSIGNAL);
+      if (n <= 0) return;  // The client went away
+      written += n;
+    }
+  }
+
+ private:
+  int fd;
+  std::string buffer;
+  std::mutex mutex;
+};
+
+template <typename Problem>
+std::string solve(const Problem& cached, const SolveRequest& request) {
+  Problem problem = cached;
+  std::unique_ptr<StoppingCriteria> criteria(request.time > 0 ? StoppingCriteria::create("time", request.time)
+                                                              : StoppingCriteria::create("iterations", request.iterations));
+  HyperGRASP<Problem, Solution, Candidate> hyper_grasp(problem, *criteria, request.alpha, request.local_search, request.is_maximization);
+  const auto statistics = hyper_grasp.solve(request.seed);
+  std::string response;
+  for (const auto& sol : statistics.solutions) {
+    response += "solution id=" + request.id;
+    for (const auto& val : sol) {
+      response += " " + std::to_string(val);
+    }
+    response += "\n";
+  }
+  response += "done id=" + request.id + " solutions=" + std::to_string(statistics.solutions.size()) +
+              " hv=" + std::to_string(std::get<2>(statistics.statistics.back())) +
+              " iterations=" + std::to_string(statistics.iterations) +
+              " time=" + std::to_string(statistics.elapsed_time) + "\n";
+  return response;
+}
+
+inline std::string request_id(const std::string& line) {
+  std::istringstream tokens(line);
+  std::string token;
+  while (tokens >> token) {
+    if (token.rfind("id=", 0) == 0) return token.substr(3);
+  }
+  return "";
+}
+
+inline int run(int argc, char* argv[]) {
+  CLI::App app{"Hyper-GRASP solve daemon"};
+  std::string socket_path;
+  int n_workers = 0;
+  app.add_option("--socket", socket_path, "Path of the UNIX domain socket")
+      ->required();
+  app.add_option("--workers", n_workers, "Number of worker threads, 0 uses one per hardware thread (int)")
+      ->default_val(0)
+      ->check(CLI::NonNegativeNumber);  // Ensure n_workers is not negative
+  CLI11_PARSE(app, argc, argv);
+  if (n_workers == 0) {
+    n_workers = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(address.sun_path)) {
+    std::cerr << "Socket path too long: " << socket_path << "\n";
+    return 1;
+  }
+  std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+  // Replace a stale socket, but never another kind of file
+  struct stat existing;
+  if (lstat(socket_path.c_str(), &existing) == 0) {
+    if (!S_ISSOCK(existing.st_mode)) {
+      std::cerr << "Not a socket, refusing to replace it: " << socket_path << "\n";
+      return 1;
+    }
+    unlink(socket_path.c_str());
+  }
+  const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(listener, 64) < 0) {
+    std::cerr << "Cannot listen on " << socket_path << ": " << std::strerror(errno) << "\n";
+    return 1;
+  }
+  std::signal(SIGPIPE, SIG_IGN);
+  std::cerr << "Serving on " << socket_path << " with " << n_workers << " workers\n";
+
+  // One reader thread per connection queues its requests on the pool. The
+  // readers use the cache and the pool, so they are joined before those are
+  // destroyed: finished ones after every accept, the others on exit.
+  struct Reader {
+    std::thread thread;
+    std::weak_ptr<Connection> connection;
+    std::shared_ptr<std::atomic<bool>> done;
+  };
+  InstanceCache cache;
+  WorkerPool pool(n_workers);
+  std::vector<Reader> readers;
+  while (true) {
+    const int fd = accept(listener, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR) continue;
+      std::cerr << "accept failed: " << std::strerror(errno) << "\n";
+      break;
+    }
+    readers.erase(std::remove_if(readers.begin(), readers.end(), [](Reader& reader) {
+                    if (!*reader.done) return false;
+                    reader.thread.join();
+                    return true;
+                  }),
+                  readers.end());
+    auto connection = std::make_shared<Connection>(fd);
+    auto done = std::make_shared<std::atomic<bool>>(false);
+    std::thread thread([connection, done, &cache, &pool] {
+      std::string line;
+      while (connection->read_line(line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        pool.submit([connection, line, &cache] {
+          try {
+            const SolveRequest request = parse_request(line);
+            const auto instance = cache.get(request);
+            connection->write_response(std::visit([&](const auto& problem) {
+              return solve(problem, request);
+            }, *instance));
+          } catch (const std::exception& e) {
+            connection->write_response("error id=" + request_id(line) + " " + e.what() + "\n");
+          }
+        });
+      }
+      *done = true;
+    });
+    readers.push_back(Reader{std::move(thread), connection, done});
+  }
+  for (auto& reader : readers) {
+    if (auto connection = reader.connection.lock()) {
+      connection->stop_reading();
+    }
+    reader.thread.join();
+  }
+  close(listener);
+  unlink(socket_path.c_str());
+  return 1;
+}
+
+}  // namespace serve
+
+#endif  // SERVE_HPP
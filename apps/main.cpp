@@ -5,16 +5,22 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
 #include <fstream>
 #include <hyper_grasp.hpp>
 #include <iostream>
 #include <mokp.hpp>
 #include <momst.hpp>
+#include <serve.hpp>
 #include <statistics.hpp>
 #include <stopping_criteria.hpp>
 
 void parseCommandLineArguments(CLI::App& app, bool& local_search, bool& is_maximization, double& alpha,
-                               std::string& criteria, int& criteria_limit, std::string& input_file, std::string& moco_problem) {
+                               std::string& criteria, int& criteria_limit, std::string& input_file, std::string& moco_problem,
+                               bool& validate, bool& reactive_alpha, std::vector<double>& alpha_values, std::string& bound,
+                               int& path_relinking, int& archive_cap, std::string& decisions_file, double& retrieve_interval,
+                               double& stagnation, double& target_ratio, std::string& combine, int& threads,
+                               bool& deterministic, int64_t& seed, int& hv_samples, int& warm_start, std::string& mode) {
   app.add_option("--local-search", local_search, "Enable local search (true/false)")
       ->default_val(true)
       ->check(CLI::IsMember({true, false}));  // Ensure the value is either true or false
@@ -29,6 +35,46 @@ void parseCommandLineArguments(CLI::App& app, bool& local_search, bool& is_maxim
       ->default_val(0.05)
       ->check(CLI::Range(0.0, 1.0));  // Ensure alpha is between 0.0 and 1.0
 
+  app.add_option("--reactive-alpha", reactive_alpha, "Sample alpha from --alpha-values with probabilities adapted to the HV gain (true/false)")
+      ->default_val(false)
+      ->check(CLI::IsMember({true, false}));  // Ensure the value is either true or false
+
+  app.add_option("--alpha-values", alpha_values, "Alpha values used by the reactive mode (comma separated doubles)")
+      ->delimiter(',')
+      ->capture_default_str()
+      ->check(CLI::Range(0.0, 1.0));  // Ensure every alpha is between 0.0 and 1.0
+
+  app.add_option("--path-relinking", path_relinking, "Relink two archive solutions every K iterations, 0 disables it (int)")
+      ->default_val(0)
+      ->check(CLI::NonNegativeNumber);  // Ensure path_relinking is not negative
+
+  app.add_option("--archive-cap", archive_cap, "Keep at most K solutions, those with the largest hypervolume contributions, 0 means unbounded (int)")
+      ->default_val(0)
+      ->check(CLI::NonNegativeNumber);  // Ensure archive_cap is not negative
+
+  app.add_option("--hv-samples", hv_samples, "With 4+ objectives, estimate candidate contributions from N quasi-random samples, 0 is exact (int)")
+      ->default_val(0)
+      ->check(CLI::NonNegativeNumber);  // Ensure hv_samples is not negative
+
+  app.add_option("--warm-start", warm_start, "Seed the archive with the solutions of N weighted sums before the iterations, 0 disables it (int)")
+      ->default_val(0)
+      ->check(CLI::NonNegativeNumber);  // Ensure warm_start is not negative
+
+  app.add_option("--mode", mode, "Run mode (string): 'grasp' or 'supported' (the supported front of a bi-objective problem by dichotomic search)")
+      ->default_val("grasp")
+      ->check(CLI::IsMember({"grasp", "supported"}));  // Ensure the mode is valid
+
+  app.add_option("--threads", threads, "Number of worker threads, iterations are scheduled by work stealing when above 1 (int)")
+      ->default_val(1)
+      ->check(CLI::PositiveNumber);  // Ensure threads is a positive number
+
+  app.add_option("--deterministic", deterministic, "Run the threads in rounds merged in iteration order, reproducible from the seed (true/false)")
+      ->default_val(false)
+      ->check(CLI::IsMember({true, false}));  // Ensure the value is either true or false
+
+  app.add_option("--seed", seed, "Random seed, 0 uses the timestamp (int)")
+      ->default_val(0);
+
   app.add_option("--criteria", criteria, "Set criteria (string)")
       ->default_val("time")
       ->check(CLI::IsMember({"time", "iterations"}));  // Ensure criteria is either time or iterations
@@ -37,6 +83,22 @@ void parseCommandLineArguments(CLI::App& app, bool& local_search, bool& is_maxim
       ->default_val(100)
       ->check(CLI::PositiveNumber);  // Ensure criteria_limit is a positive number
 
+  app.add_option("--retrieve-interval", retrieve_interval, "Seconds or iterations between statistics samples, 0 uses the default of the criteria (double)")
+      ->default_val(0)
+      ->check(CLI::NonNegativeNumber);  // Ensure retrieve_interval is not negative
+
+  app.add_option("--stagnation", stagnation, "Also stop when the hypervolume has not improved for this many seconds, 0 disables it (double)")
+      ->default_val(0)
+      ->check(CLI::NonNegativeNumber);  // Ensure stagnation is not negative
+
+  app.add_option("--target-ratio", target_ratio, "Also stop when ratio_hv against the known front reaches this value, 0 disables it (double)")
+      ->default_val(0)
+      ->check(CLI::Range(0.0, 1.0));  // Ensure target_ratio is between 0.0 and 1.0
+
+  app.add_option("--combine", combine, "Stop when 'any' or 'all' of the criteria are met (string)")
+      ->default_val("any")
+      ->check(CLI::IsMember({"any", "all"}));  // Ensure combine is either any or all
+
   app.add_option("--input-file", input_file, "Input file with the problem instance")
       ->required()
       ->check(CLI::ExistingFile);  // Ensure the file exists
@@ -44,13 +106,50 @@ void parseCommandLineArguments(CLI::App& app, bool& local_search, bool& is_maxim
   app.add_option("--moco-problem", moco_problem, "MOCO problem (string): 'mokp' or 'momst'")
       ->default_val("mokp")
       ->check(CLI::IsMember({"mokp", "momst"}));  // Ensure the problem is either mokp or momst
+
+  app.add_option("--bound", bound, "MOKP upper bound used to score candidates (string): 'dantzig' or 'mt' (Martello-Toth)")
+      ->default_val("dantzig")
+      ->check(CLI::IsMember({"dantzig", "mt"}));  // Ensure the bound is either dantzig or mt
+
+  app.add_option("--decisions-file", decisions_file, "Write the decision vectors of the final solutions to this file");
+
+  app.add_option("--validate", validate, "Check the final solutions for dominance errors (true/false)")
+      ->default_val(true)
+      ->check(CLI::IsMember({true, false}));  // Ensure the value is either true or false
 }
 
-std::unique_ptr<StoppingCriteria> createStoppingCriteria(const std::string& criteria, int criteria_limit) {
-  return std::unique_ptr<StoppingCriteria>(StoppingCriteria::create(criteria, criteria_limit));
+std::unique_ptr<StoppingCriteria> createStoppingCriteria(const std::string& criteria, int criteria_limit, double retrieve_interval,
+                                                         double stagnation, double target_ratio, const std::string& combine) {
+  std::vector<std::unique_ptr<StoppingCriteria>> all_criteria;
+  all_criteria.emplace_back(StoppingCriteria::create(criteria, criteria_limit, retrieve_interval));
+  if (stagnation > 0) {
+    all_criteria.emplace_back(StoppingCriteria::create("stagnation", stagnation));
+  }
+  if (target_ratio > 0) {
+    all_criteria.emplace_back(StoppingCriteria::create("target-ratio", target_ratio));
+  }
+  if (all_criteria.size() == 1) {
+    return std::move(all_criteria.front());
+  }
+  auto mode = combine == "all" ? CombinedStoppingCriteria::Mode::All : CombinedStoppingCriteria::Mode::Any;
+  return std::make_unique<CombinedStoppingCriteria>(std::move(all_criteria), mode);
+}
+
+void printCandidateCounters(const CandidateCounters& counters) {
+  std::cerr << "Candidate lists: " << counters.steps << " built, " << counters.average_candidates() << " candidates on average, "
+            << counters.generation_time << " s building them\n";
+  if (counters.cache_tests > 0) {
+    std::cerr << "Dominator cache: " << counters.cache_hits << " of " << counters.cache_tests << " bounds rejected ("
+              << 100.0 * counters.cache_hit_rate() << "%)\n";
+  }
 }
 
 int main(int argc, char* argv[]) {
+  // `hyper-grasp serve ...` runs the solve daemon
+  if (argc > 1 && std::string(argv[1]) == "serve") {
+    return serve::run(argc - 1, argv + 1);
+  }
+
   CLI::App app{"Hyper-GRASP for Multiobjective Combinatorial Optimization"};
 
   bool local_search = false;
@@ -60,9 +159,26 @@ int main(int argc, char* argv[]) {
   int criteria_limit = 0;
   std::string input_file;
   std::string moco_problem;
+  bool validate = true;
+  bool reactive_alpha = false;
+  std::vector<double> alpha_values = {0.0, 0.05, 0.1, 0.2, 0.3, 0.5};
+  std::string bound;
+  int path_relinking = 0;
+  int archive_cap = 0;
+  std::string decisions_file;
+  double retrieve_interval = 0;
+  double stagnation = 0;
+  double target_ratio = 0;
+  std::string combine;
+  int threads = 1;
+  bool deterministic = false;
+  int64_t seed = 0;
+  int hv_samples = 0;
+  int warm_start = 0;
+  std::string mode;
 
   // Parse the command line arguments
-  parseCommandLineArguments(app, local_search, is_maximization, alpha, criteria, criteria_limit, input_file, moco_problem);
+  parseCommandLineArguments(app, local_search, is_maximization, alpha, criteria, criteria_limit, input_file, moco_problem, validate, reactive_alpha, alpha_values, bound, path_relinking, archive_cap, decisions_file, retrieve_interval, stagnation, target_ratio, combine, threads, deterministic, seed, hv_samples, warm_start, mode);
   CLI11_PARSE(app, argc, argv);
 
   // Output the parsed values
@@ -70,28 +186,63 @@ int main(int argc, char* argv[]) {
   std::cerr << " - is_maximization: " << std::boolalpha << is_maximization << "\n";
   std::cerr << " - local_search: " << std::boolalpha << local_search << "\n";
   std::cerr << " - alpha: " << alpha << "\n";
+  std::cerr << " - reactive_alpha: " << std::boolalpha << reactive_alpha << "\n";
+  std::cerr << " - path_relinking: " << path_relinking << "\n";
+  std::cerr << " - archive_cap: " << archive_cap << "\n";
+  std::cerr << " - hv_samples: " << hv_samples << "\n";
+  std::cerr << " - warm_start: " << warm_start << "\n";
+  std::cerr << " - mode: " << mode << "\n";
   std::cerr << " - criteria: " << criteria << "\n";
   std::cerr << " - criteria_limit: " << criteria_limit << "\n";
+  std::cerr << " - stagnation: " << stagnation << "\n";
+  std::cerr << " - target_ratio: " << target_ratio << "\n";
+  std::cerr << " - combine: " << combine << "\n";
   std::cerr << " - input_file: " << input_file << "\n";
   std::cerr << " - moco_problem: " << moco_problem << "\n";
+  std::cerr << " - bound: " << bound << "\n";
+  std::cerr << " - threads: " << threads << "\n";
+  std::cerr << " - deterministic: " << std::boolalpha << deterministic << "\n";
+  std::cerr << " - validate: " << std::boolalpha << validate << "\n";
+
+  if (!reactive_alpha) {
+    alpha_values.clear();
+  }
+
+  if (seed == 0) {
+    seed = std::time(0);
+  }
 
   // Create the stopping criteria
-  auto stopping_criteria = createStoppingCriteria(criteria, criteria_limit);
+  auto stopping_criteria = createStoppingCriteria(criteria, criteria_limit, retrieve_interval, stagnation, target_ratio, combine);
 
   // Solve the problem
   if (moco_problem == "mokp") {
-    MOKP<Solution, Candidate> problem = MOKP<Solution, Candidate>::from_stream(std::ifstream(input_file));
-    HyperGRASP<MOKP<Solution, Candidate>, Solution, Candidate> hyper_grasp(problem, *stopping_criteria, alpha, local_search, is_maximization);
-    Statistics<MOKP<Solution, Candidate>, Solution> statistics = hyper_grasp.solve();
+    MOKP<Solution, Candidate> problem = MOKP<Solution, Candidate>::from_stream(std::ifstream(input_file), bound == "mt" ? BoundType::MartelloToth : BoundType::Dantzig);
+    HyperGRASP<MOKP<Solution, Candidate>, Solution, Candidate> hyper_grasp(problem, *stopping_criteria, alpha, local_search, is_maximization, validate, alpha_values, path_relinking, archive_cap, hv_samples, warm_start);
+    Statistics<MOKP<Solution, Candidate>, Solution> statistics =
+        mode == "supported"            ? SupportedFront<MOKP<Solution, Candidate>, Solution>(problem, is_maximization).solve()
+        : threads > 1 || deterministic ? hyper_grasp.solveParallel(seed, threads, deterministic)
+                                       : hyper_grasp.solve(seed);
     std::cout << "Statistics:\n";
     std::cout << statistics.to_string() << std::endl;
+    printCandidateCounters(statistics.counters);
+    if (!decisions_file.empty()) {
+      statistics.to_decisions_file(decisions_file);
+    }
     statistics.to_debug_file();
   } else if (moco_problem == "momst") {
     MOMST<Solution, Candidate> problem = MOMST<Solution, Candidate>::from_stream(std::ifstream(input_file));
-    HyperGRASP<MOMST<Solution, Candidate>, Solution, Candidate> hyper_grasp(problem, *stopping_criteria, alpha, local_search, is_maximization);
-    Statistics<MOMST<Solution, Candidate>, Solution> statistics = hyper_grasp.solve();
+    HyperGRASP<MOMST<Solution, Candidate>, Solution, Candidate> hyper_grasp(problem, *stopping_criteria, alpha, local_search, is_maximization, validate, alpha_values, path_relinking, archive_cap, hv_samples, warm_start);
+    Statistics<MOMST<Solution, Candidate>, Solution> statistics =
+        mode == "supported"            ? SupportedFront<MOMST<Solution, Candidate>, Solution>(problem, is_maximization).solve()
+        : threads > 1 || deterministic ? hyper_grasp.solveParallel(seed, threads, deterministic)
+                                       : hyper_grasp.solve(seed);
     std::cout << "Statistics:\n";
     std::cout << statistics.to_string() << std::endl;
+    printCandidateCounters(statistics.counters);
+    if (!decisions_file.empty()) {
+      statistics.to_decisions_file(decisions_file);
+    }
     statistics.to_debug_file();
   } else {
     std::cerr << "Invalid problem: " << moco_problem << "\n";
@@ -0,0 +1,207 @@
+#ifndef ARCHIVE_PRUNING_HPP
+#define ARCHIVE_PRUNING_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <dominance_archive.hpp>
+#include <functional>
+#include <indicator.hpp>
+#include <map>
+#include <numeric>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+// Least-contributor pruning of a set of mutually nondominated solutions. The
+// solution with the smallest exclusive hypervolume contribution is removed
+// until `capacity` remain, and only the contributions that the removal can
+// change are updated:
+// - 2 objectives: the solutions form a staircase, a removal only changes the
+//   contributions of its two neighbours.
+// - 3+ objectives: removing r only changes the contribution of p if the
+//   region dominated by both, bounded by min(p, r), is not also dominated by
+//   a third solution. That is tested with one query on a DominanceArchive.
+//   The contributions of the kept solutions are also kept for the next
+//   prune, which only recomputes those of the new solutions and of the ones
+//   that a solution added or removed in between can change (the same test).
+//   Without that, every prune would compute n contributions of O(n log n).
+template <typename T, typename Solution>
+class LeastContributorPruning {
+ public:
+  LeastContributorPruning(const Solution& ref_point, bool is_maximization = true)
+      : ref(is_maximization ? ref_point : negate(ref_point)), is_maximization(is_maximization) {}
+
+  // Indices, in increasing order, of the solutions that are kept. Repeated
+  // calls should prune the same archive.
+  [[nodiscard]] std::vector<std::size_t> keep(const std::vector<Solution>& solutions, std::size_t capacity) {
+    std::vector<std::size_t> kept(solutions.size());
+    std::iota(kept.begin(), kept.end(), 0);
+    if (solutions.size() <= capacity) {
+      return kept;
+    }
+    std::vector<Solution> points;
+    points.reserve(solutions.size());
+    for (const auto& sol : solutions) {
+      points.push_back(is_maximization ? sol : negate(sol));
+    }
+    std::vector<bool> removed = ref.size() == 2 ? prune_2d(points, capacity) : prune(points, capacity);
+    kept.erase(std::remove_if(kept.begin(), kept.end(), [&](std::size_t i) {
+                 return removed[i];
+               }),
+               kept.end());
+    return kept;
+  }
+
+ private:
+  // (contribution, index, version) with the smallest contribution on top
+  using Entry = std::tuple<T, std::size_t, uint32_t>;
+  using MinHeap = std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>;
+
+  const Solution ref;
+  const bool is_maximization;
+  std::map<Solution, T> kept_contributions;  // Of the solutions kept by the previous prune (3+ objectives)
+
+  static Solution negate(const Solution& sol) {
+    Solution res(sol.size());
+    std::transform(sol.begin(), sol.end(), res.begin(), std::negate<T>());
+    return res;
+  }
+
+  std::vector<bool> prune_2d(const std::vector<Solution>& points, std::size_t capacity) const {
+    const std::size_t n = points.size();
+    // Staircase order: x decreasing, so y increasing
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+      return points[a][0] != points[b][0] ? points[a][0] > points[b][0] : points[a][1] < points[b][1];
+    });
+    // Neighbours in the staircase, n marks the reference point
+    std::vector<std::size_t> prev(n, n), next(n, n);
+    for (std::size_t k = 0; k + 1 < n; ++k) {
+      next[order[k]] = order[k + 1];
+      prev[order[k + 1]] = order[k];
+    }
+    auto contribution = [&](std::size_t i) {
+      const T x_next = next[i] != n ? points[next[i]][0] : ref[0];
+      const T y_prev = prev[i] != n ? points[prev[i]][1] : ref[1];
+      return (points[i][0] - x_next) * (points[i][1] - y_prev);
+    };
+    std::vector<uint32_t> version(n, 0);
+    std::vector<bool> removed(n, false);
+    MinHeap heap;
+    for (std::size_t i = 0; i < n; ++i) {
+      heap.emplace(contribution(i), i, 0);
+    }
+    for (std::size_t size = n; size > capacity;) {
+      const auto [hvc, r, v] = heap.top();
+      heap.pop();
+      if (removed[r] || v != version[r]) continue;
+      removed[r] = true;
+      --size;
+      if (prev[r] != n) next[prev[r]] = next[r];
+      if (next[r] != n) prev[next[r]] = prev[r];
+      for (const std::size_t& i : {prev[r], next[r]}) {
+        if (i == n) continue;
+        heap.emplace(contribution(i), i, ++version[i]);
+      }
+    }
+    return removed;
+  }
+
+  std::vector<bool> prune(const std::vector<Solution>& points, std::size_t capacity) {
+    const std::size_t n = points.size();
+    const std::size_t m = ref.size();
+    DominanceArchive<T> archive(points, m, true);
+    std::vector<std::size_t> ids(n);  // Index of each point of the archive
+    std::iota(ids.begin(), ids.end(), 0);
+
+    // Exclusive contribution of p: its box minus the region dominated by the others
+    std::vector<Solution> limited;
+    auto contribution = [&](std::size_t p) {
+      limited.clear();
+      for (const std::size_t& q : ids) {
+        if (q == p) continue;
+        Solution lim(m);
+        for (std::size_t k = 0; k < m; ++k) {
+          lim[k] = std::min(points[p][k], points[q][k]);
+        }
+        limited.push_back(std::move(lim));
+      }
+      T box = 1;
+      for (std::size_t k = 0; k < m; ++k) {
+        box *= points[p][k] - ref[k];
+      }
+      return box - HypervolumeIndicator<T, Solution>::compute(ref, limited, true);
+    };
+    auto limit = [&](const Solution& p, const Solution& r, Solution& lim) {
+      for (std::size_t k = 0; k < m; ++k) {
+        lim[k] = std::min(p[k], r[k]);
+      }
+    };
+
+    // Contributions kept by the previous prune that no change since can affect
+    std::vector<T> contributions(n);
+    std::vector<bool> known(n, false);
+    std::vector<Solution> changed;  // Points added or removed since the previous prune
+    DominanceArchive<T> unchanged(m, true);
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto it = kept_contributions.find(points[i]);
+      if (it == kept_contributions.end()) {
+        changed.push_back(points[i]);
+        continue;
+      }
+      contributions[i] = it->second;
+      known[i] = true;
+      unchanged.push_back(points[i]);
+      kept_contributions.erase(it);
+    }
+    // The rest were removed from the archive
+    for (const auto& entry : kept_contributions) {
+      changed.push_back(entry.first);
+    }
+    kept_contributions.clear();
+    Solution lim(m);
+    for (std::size_t p = 0; p < n; ++p) {
+      if (!known[p]) continue;
+      for (const auto& c : changed) {
+        limit(points[p], c, lim);
+        // As below, but the third point must be unchanged to cover the region both before and after
+        if (unchanged.count_weakly_dominating(lim) > 1) continue;
+        known[p] = false;
+        break;
+      }
+    }
+
+    std::vector<uint32_t> version(n, 0);
+    std::vector<bool> removed(n, false);
+    MinHeap heap;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (!known[i]) {
+        contributions[i] = contribution(i);
+      }
+      heap.emplace(contributions[i], i, 0);
+    }
+    for (std::size_t size = n; size > capacity;) {
+      const auto [hvc, r, v] = heap.top();
+      heap.pop();
+      if (removed[r] || v != version[r]) continue;
+      removed[r] = true;
+      --size;
+      archive.remove_weakly_dominated(points[r], ids);
+      for (std::size_t j = 0; j < ids.size(); ++j) {
+        const std::size_t p = ids[j];
+        limit(points[p], points[r], lim);
+        // p always dominates lim, any other point means the shared region is still covered
+        if (archive.count_weakly_dominating(lim) > 1) continue;
+        contributions[p] = contribution(p);
+        heap.emplace(contributions[p], p, ++version[p]);
+      }
+    }
+    for (const std::size_t& i : ids) {
+      kept_contributions.emplace(points[i], contributions[i]);
+    }
+    return removed;
+  }
+};
+
+#endif  // ARCHIVE_PRUNING_HPP
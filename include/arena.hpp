@@ -0,0 +1,67 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+// Monotonic scratch memory for one worker, reset at the top of every
+// iteration. Allocations that do not fit in the buffer go to the heap and are
+// counted; on the next reset the buffer grows to cover them, so once the
+// buffer reaches the high-water mark an iteration does no malloc/free.
+class Arena {
+ public:
+  explicit Arena(std::size_t initial_size = 1 << 16) : buffer(initial_size) {
+    monotonic.emplace(buffer.data(), buffer.size(), &upstream);
+  }
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  [[nodiscard]] std::pmr::memory_resource* resource() {
+    return &*monotonic;
+  }
+
+  [[nodiscard]] std::size_t capacity() const {
+    return buffer.size();
+  }
+
+  // Release everything allocated since the last reset. Memory obtained from
+  // the arena must not be used afterwards.
+  void reset() {
+    monotonic.reset();
+    if (upstream.overflow > 0) {
+      buffer = std::vector<std::byte>(2 * (buffer.size() + upstream.overflow));
+      upstream.overflow = 0;
+    }
+    monotonic.emplace(buffer.data(), buffer.size(), &upstream);
+  }
+
+ private:
+  // Heap resource that records how many bytes were requested from it
+  class CountingResource : public std::pmr::memory_resource {
+   public:
+    std::size_t overflow = 0;
+
+   private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+      overflow += bytes;
+      return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+      std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+      return this == &other;
+    }
+  };
+
+  std::vector<std::byte> buffer;
+  CountingResource upstream;
+  std::optional<std::pmr::monotonic_buffer_resource> monotonic;
+};
+
+#endif  // ARENA_HPP
@@ -0,0 +1,171 @@
+#ifndef DECISION_VECTOR_HPP
+#define DECISION_VECTOR_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Decision variables of a solution (e.g. the items in a knapsack or the edges
+// of a tree), one bit per variable. The dense form is a packed bitset padded
+// to whole 512-bit blocks, so that the word loops below have no tail and can
+// be vectorized. Archived vectors can be compacted to the sparse form, the
+// sorted indices of the variables set, which is smaller when few variables
+// are set (e.g. the V - 1 edges of a tree out of V(V-1)/2).
+class DecisionVector {
+ public:
+  DecisionVector() = default;
+
+  explicit DecisionVector(std::size_t n_bits) : n_bits(n_bits), words(n_words(n_bits), 0) {}
+
+  [[nodiscard]] std::size_t size() const {
+    return n_bits;
+  }
+
+  [[nodiscard]] bool is_sparse() const {
+    return sparse;
+  }
+
+  // Bytes used by the variables
+  [[nodiscard]] std::size_t memory() const {
+    return words.capacity() * sizeof(uint64_t) + indices.capacity() * sizeof(uint32_t);
+  }
+
+  [[nodiscard]] bool test(std::size_t i) const {
+    if (sparse) {
+      return std::binary_search(indices.begin(), indices.end(), static_cast<uint32_t>(i));
+    }
+    return (words[i / 64] >> (i % 64)) & 1;
+  }
+
+  // set, reset and flip require the dense form
+  void set(std::size_t i) {
+    assert(!sparse);
+    words[i / 64] |= uint64_t{1} << (i % 64);
+  }
+
+  void reset(std::size_t i) {
+    assert(!sparse);
+    words[i / 64] &= ~(uint64_t{1} << (i % 64));
+  }
+
+  void flip(std::size_t i) {
+    assert(!sparse);
+    words[i / 64] ^= uint64_t{1} << (i % 64);
+  }
+
+  // Clear every variable, keeping the size. The vector becomes dense.
+  void clear() {
+    sparse = false;
+    indices.clear();
+    words.assign(n_words(n_bits), 0);
+  }
+
+  // Switch to the sparse form if it uses less memory than the dense one
+  void compact() {
+    if (sparse || count() * 32 >= n_bits) {
+      return;
+    }
+    std::vector<uint32_t> set_indices;
+    set_indices.reserve(count());
+    for_each_set([&](std::size_t i) {
+      set_indices.push_back(i);
+    });
+    indices = std::move(set_indices);
+    std::vector<uint64_t>().swap(words);
+    sparse = true;
+  }
+
+  // Switch back to the dense form
+  void expand() {
+    if (!sparse) {
+      return;
+    }
+    words.assign(n_words(n_bits), 0);
+    for (const auto& i : indices) {
+      words[i / 64] |= uint64_t{1} << (i % 64);
+    }
+    std::vector<uint32_t>().swap(indices);
+    sparse = false;
+  }
+
+  // Number of variables set
+  [[nodiscard]] std::size_t count() const {
+    if (sparse) {
+      return indices.size();
+    }
+    std::size_t count = 0;
+    for (const auto& word : words) {
+      count += std::popcount(word);
+    }
+    return count;
+  }
+
+  // Calls visit(i) for every variable set, in increasing order
+  template <typename Visit>
+  void for_each_set(Visit&& visit) const {
+    if (sparse) {
+      for (const auto& i : indices) {
+        visit(i);
+      }
+      return;
+    }
+    for (std::size_t w = 0; w < words.size(); ++w) {
+      for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+        visit(w * 64 + std::countr_zero(word));
+      }
+    }
+  }
+
+  // Calls visit(i) for every variable that differs between a and b
+  template <typename Visit>
+  static void for_each_difference(const DecisionVector& a, const DecisionVector& b, Visit&& visit) {
+    if (!a.sparse && !b.sparse) {
+      for (std::size_t w = 0; w < a.words.size(); ++w) {
+        for (uint64_t word = a.words[w] ^ b.words[w]; word != 0; word &= word - 1) {
+          visit(w * 64 + std::countr_zero(word));
+        }
+      }
+      return;
+    }
+    a.for_each_set([&](std::size_t i) {
+      if (!b.test(i)) visit(i);
+    });
+    b.for_each_set([&](std::size_t i) {
+      if (!a.test(i)) visit(i);
+    });
+  }
+
+  // Hamming distance, the number of variables that differ
+  [[nodiscard]] static std::size_t distance(const DecisionVector& a, const DecisionVector& b) {
+    if (!a.sparse && !b.sparse) {
+      std::size_t distance = 0;
+      for (std::size_t w = 0; w < a.words.size(); ++w) {
+        distance += std::popcount(a.words[w] ^ b.words[w]);
+      }
+      return distance;
+    }
+    // |a| + |b| - 2 |a & b|, iterating over the sparse side
+    const DecisionVector& s = a.sparse ? a : b;
+    const DecisionVector& o = a.sparse ? b : a;
+    std::size_t common = 0;
+    for (const auto& i : s.indices) {
+      common += o.test(i);
+    }
+    return a.count() + b.count() - 2 * common;
+  }
+
+ private:
+  std::size_t n_bits = 0;
+  std::vector<uint64_t> words;    // Dense form, empty when sparse
+  std::vector<uint32_t> indices;  // Sparse form, sorted
+  bool sparse = false;
+
+  static std::size_t n_words(std::size_t n_bits) {
+    return (n_bits + 511) / 512 * 8;
+  }
+};
+
+#endif  // DECISION_VECTOR_HPP
@@ -2,6 +2,7 @@
 #define DOMINANCE_HPP
 
 #include <algorithm>
+#include <dominance_archive.hpp>
 #include <iostream>
 #include <vector>
 
@@ -81,41 +82,70 @@ void remove_weakly_dominated(std::vector<std::vector<T>>& solutions, const std::
   }
 }
 
+// Same as above, also removing the entries of payload (one per solution, e.g.
+// the decision vectors) that belong to the removed solutions
+template <typename T, typename Payload>
+void remove_weakly_dominated(std::vector<std::vector<T>>& solutions, std::vector<Payload>& payload, const std::vector<T>& sol,
+                             const bool& is_maximization) {
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < solutions.size(); ++i) {
+    if (weakly_dominates(sol, solutions[i], is_maximization)) continue;
+    if (kept != i) {
+      solutions[kept] = std::move(solutions[i]);
+      payload[kept] = std::move(payload[i]);
+    }
+    ++kept;
+  }
+  solutions.resize(kept);
+  payload.resize(kept);
+}
+
+// Check that no solution is weakly dominated by another solution and that no
+// solution strictly dominates a point of the nondominated set. The dominance
+// queries run against an SoA archive of the solutions.
 template <typename Solution>
 bool valid_solutions(const std::vector<Solution>& solutions, const std::vector<Solution>& n_set, const bool& is_maximization) {
+  if (solutions.empty()) {
+    return true;
+  }
+  const DominanceArchive<typename Solution::value_type> archive(solutions, solutions[0].size(), is_maximization);
+
   for (size_t i = 0; i < solutions.size(); ++i) {
+    // The solution always weakly dominates itself
+    if (archive.count_weakly_dominating(solutions[i]) <= 1) continue;
     for (size_t j = 0; j < solutions.size(); ++j) {
       if (i != j && weakly_dominates(solutions[j], solutions[i], is_maximization)) {
-        std::cout << "Solution " << i << " is dominated by solution " << j << std::endl;
-        std::cout << "Solution " << i << ": ";
+        std::cerr << "Solution " << i << " is dominated by solution " << j << std::endl;
+        std::cerr << "Solution " << i << ": ";
         for (const auto& val : solutions[i]) {
-          std::cout << val << " ";
+          std::cerr << val << " ";
         }
-        std::cout << std::endl;
-        std::cout << "Solution " << j << ": ";
+        std::cerr << std::endl;
+        std::cerr << "Solution " << j << ": ";
         for (const auto& val : solutions[j]) {
-          std::cout << val << " ";
+          std::cerr << val << " ";
         }
-        std::cout << std::endl;
+        std::cerr << std::endl;
         return false;
       }
     }
   }
 
-  for (size_t i = 0; i < solutions.size(); ++i) {
-    for (size_t j = 0; j < n_set.size(); ++j) {
+  for (size_t j = 0; j < n_set.size(); ++j) {
+    if (!archive.any_strictly_dominates(n_set[j])) continue;
+    for (size_t i = 0; i < solutions.size(); ++i) {
       if (strictly_dominates(solutions[i], n_set[j], is_maximization)) {
-        std::cout << "Non-dominated set solution " << j << " is dominated by solution " << i << std::endl;
-        std::cout << "Solution " << i << ": ";
+        std::cerr << "Non-dominated set solution " << j << " is dominated by solution " << i << std::endl;
+        std::cerr << "Solution " << i << ": ";
         for (const auto& val : solutions[i]) {
-          std::cout << val << " ";
+          std::cerr << val << " ";
         }
-        std::cout << std::endl;
-        std::cout << "Non-dominated solution " << j << ": ";
+        std::cerr << std::endl;
+        std::cerr << "Non-dominated solution " << j << ": ";
         for (const auto& val : n_set[j]) {
-          std::cout << val << " ";
+          std::cerr << val << " ";
         }
-        std::cout << std::endl;
+        std::cerr << std::endl;
         return false;
       }
     }
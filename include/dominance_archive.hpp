@@ -0,0 +1,307 @@
+#ifndef DOMINANCE_ARCHIVE_HPP
+#define DOMINANCE_ARCHIVE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Runtime dispatch to AVX2/AVX-512 kernels is only available on Linux x86-64
+// with GCC/Clang. Everywhere else the scalar kernel is used.
+#if defined(__x86_64__) && defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+#define HYPER_GRASP_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace dominance_kernels {
+
+enum class Isa { Scalar,
+                 AVX2,
+                 AVX512 };
+
+inline Isa detect_isa() {
+#ifdef HYPER_GRASP_X86_DISPATCH
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return Isa::AVX512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return Isa::AVX2;
+  }
+#endif
+  return Isa::Scalar;
+}
+
+// The instruction set is detected once and reused for every query
+inline Isa active_isa() {
+  static const Isa isa = detect_isa();
+  return isa;
+}
+
+// A query compares every archive point x against a single point q. When
+// archive_lhs is true the relation tested is x >= q (or x > q if strict) in
+// every objective, otherwise q >= x (or q > x). Minimization is handled by
+// the caller by swapping the sides of the relation.
+struct Query {
+  bool archive_lhs;
+  bool strict;
+};
+
+template <typename T>
+inline bool scalar_relation(const T& lhs, const T& rhs, const bool& strict) {
+  return strict ? lhs > rhs : lhs >= rhs;
+}
+
+// Bitmask of the points in [base, base + width) that satisfy the query
+template <typename Columns, typename T>
+inline uint32_t scalar_block(const Columns& columns, const std::size_t& base, const std::size_t& width,
+                             const std::vector<T>& q, const Query& query) {
+  uint32_t mask = 0;
+  for (std::size_t j = 0; j < width; ++j) {
+    bool holds = true;
+    for (std::size_t k = 0; k < columns.size() && holds; ++k) {
+      const T& x = columns[k][base + j];
+      holds = query.archive_lhs ? scalar_relation(x, q[k], query.strict) : scalar_relation(q[k], x, query.strict);
+    }
+    mask |= static_cast<uint32_t>(holds) << j;
+  }
+  return mask;
+}
+
+#ifdef HYPER_GRASP_X86_DISPATCH
+// 4 points per instruction. Lanes that violate the relation in any objective
+// are accumulated in `violated`.
+template <typename Columns>
+__attribute__((target("avx2"))) inline uint32_t avx2_block(const Columns& columns, const std::size_t& base,
+                                                           const std::vector<int64_t>& q, const Query& query) {
+  __m256i violated = _mm256_setzero_si256();
+  const __m256i ones = _mm256_set1_epi64x(-1);
+  for (std::size_t k = 0; k < columns.size(); ++k) {
+    const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns[k].data() + base));
+    const __m256i y = _mm256_set1_epi64x(q[k]);
+    const __m256i lhs = query.archive_lhs ? x : y;
+    const __m256i rhs = query.archive_lhs ? y : x;
+    // lhs >= rhs fails iff rhs > lhs; lhs > rhs fails iff !(lhs > rhs)
+    const __m256i fails = query.strict ? _mm256_xor_si256(_mm256_cmpgt_epi64(lhs, rhs), ones) : _mm256_cmpgt_epi64(rhs, lhs);
+    violated = _mm256_or_si256(violated, fails);
+  }
+  return ~static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(violated))) & 0xFu;
+}
+
+// 8 points per instruction
+template <typename Columns>
+__attribute__((target("avx512f"))) inline uint32_t avx512_block(const Columns& columns, const std::size_t& base,
+                                                                const std::vector<int64_t>& q, const Query& query) {
+  __mmask8 violated = 0;
+  for (std::size_t k = 0; k < columns.size(); ++k) {
+    const __m512i x = _mm512_loadu_si512(columns[k].data() + base);
+    const __m512i y = _mm512_set1_epi64(q[k]);
+    const __m512i lhs = query.archive_lhs ? x : y;
+    const __m512i rhs = query.archive_lhs ? y : x;
+    violated |= query.strict ? _mm512_cmple_epi64_mask(lhs, rhs) : _mm512_cmpgt_epi64_mask(rhs, lhs);
+  }
+  return static_cast<uint32_t>(static_cast<uint8_t>(~violated));
+}
+#endif
+
+// Calls `visit(base, width, mask)` for consecutive blocks of points until it
+// returns false. Blocks are 8, 4 or 1 points wide depending on the instruction
+// set.
+template <typename Columns, typename T, typename Visit>
+inline void for_each_block(const Columns& columns, const std::size_t& n, const std::vector<T>& q,
+                           const Query& query, Visit&& visit) {
+  std::size_t base = 0;
+#ifdef HYPER_GRASP_X86_DISPATCH
+  if constexpr (std::is_same_v<T, int64_t>) {
+    const Isa isa = active_isa();
+    if (isa == Isa::AVX512) {
+      for (; base + 8 <= n; base += 8) {
+        if (!visit(base, 8, avx512_block(columns, base, q, query))) return;
+      }
+    }
+    if (isa == Isa::AVX512 || isa == Isa::AVX2) {
+      for (; base + 4 <= n; base += 4) {
+        if (!visit(base, 4, avx2_block(columns, base, q, query))) return;
+      }
+    }
+  }
+#endif
+  for (; base < n; ++base) {
+    if (!visit(base, 1, scalar_block(columns, base, 1, q, query))) return;
+  }
+}
+
+}  // namespace dominance_kernels
+
+// Structure-of-arrays view of a set of objective vectors. Each objective is
+// stored in its own contiguous column so that a candidate can be compared
+// against several archive points at once. The columns can be placed in
+// scratch memory by passing a memory resource.
+template <typename T>
+class DominanceArchive {
+ public:
+  DominanceArchive(std::size_t n_objectives, bool is_maximization = true,
+                   std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : columns(n_objectives, resource), is_maximization(is_maximization) {}
+
+  DominanceArchive(const std::vector<std::vector<T>>& solutions, std::size_t n_objectives, bool is_maximization = true,
+                   std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : DominanceArchive(n_objectives, is_maximization, resource) {
+    reserve(solutions.size());
+    for (const auto& sol : solutions) {
+      push_back(sol);
+    }
+  }
+
+  [[nodiscard]] std::size_t size() const {
+    return n;
+  }
+
+  [[nodiscard]] bool empty() const {
+    return n == 0;
+  }
+
+  void clear() {
+    for (auto& column : columns) {
+      column.clear();
+    }
+    n = 0;
+  }
+
+  void reserve(std::size_t capacity) {
+    for (auto& column : columns) {
+      column.reserve(capacity);
+    }
+  }
+
+  void push_back(const std::vector<T>& sol) {
+    for (std::size_t k = 0; k < columns.size(); ++k) {
+      columns[k].push_back(sol[k]);
+    }
+    ++n;
+  }
+
+  [[nodiscard]] std::vector<T> operator[](std::size_t i) const {
+    std::vector<T> sol(columns.size());
+    for (std::size_t k = 0; k < columns.size(); ++k) {
+      sol[k] = columns[k][i];
+    }
+    return sol;
+  }
+
+  [[nodiscard]] std::vector<std::vector<T>> to_vector() const {
+    std::vector<std::vector<T>> solutions;
+    copy_to(solutions);
+    return solutions;
+  }
+
+  // Copy the points into solutions, reusing its existing storage
+  void copy_to(std::vector<std::vector<T>>& solutions) const {
+    solutions.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      solutions[i].resize(columns.size());
+      for (std::size_t k = 0; k < columns.size(); ++k) {
+        solutions[i][k] = columns[k][i];
+      }
+    }
+  }
+
+  // True if no point in the archive weakly dominates sol
+  [[nodiscard]] bool is_non_dominated(const std::vector<T>& sol) const {
+    return !any(sol, {is_maximization, false});
+  }
+
+  // True if some point in the archive strictly dominates sol
+  [[nodiscard]] bool any_strictly_dominates(const std::vector<T>& sol) const {
+    return any(sol, {is_maximization, true});
+  }
+
+  // Number of points in the archive that weakly dominate sol
+  [[nodiscard]] std::size_t count_weakly_dominating(const std::vector<T>& sol) const {
+    std::size_t count = 0;
+    dominance_kernels::for_each_block(columns, n, sol, {is_maximization, false}, [&](std::size_t, std::size_t, uint32_t mask) {
+      count += std::popcount(mask);
+      return true;
+    });
+    return count;
+  }
+
+  // Tighten lower, a lower corner of the region that only sol dominates, to
+  // the value in objective k of every point that is at least as good as sol in
+  // every objective but k (any vector below it in k is dominated by that point)
+  void tighten_exclusive_corner(const std::vector<T>& sol, std::vector<T>& lower) const {
+    for (std::size_t i = 0; i < n; ++i) {
+      std::size_t worse = columns.size();
+      std::size_t n_worse = 0;
+      for (std::size_t k = 0; k < columns.size() && n_worse < 2; ++k) {
+        if (is_maximization ? columns[k][i] < sol[k] : columns[k][i] > sol[k]) {
+          worse = k;
+          n_worse++;
+        }
+      }
+      if (n_worse == 1) {
+        lower[worse] = is_maximization ? std::max(lower[worse], columns[worse][i]) : std::min(lower[worse], columns[worse][i]);
+      }
+    }
+  }
+
+  // Remove the points weakly dominated by sol, keeping the order of the rest.
+  // Returns the number of removed points.
+  std::size_t remove_weakly_dominated(const std::vector<T>& sol) {
+    return remove_weakly_dominated(sol, [](std::size_t, std::size_t) {}, [](std::size_t) {});
+  }
+
+  // Same as above, also compacting payload, a vector with one entry per point
+  // (e.g. the decision vectors of the points)
+  template <typename Payload>
+  std::size_t remove_weakly_dominated(const std::vector<T>& sol, std::vector<Payload>& payload) {
+    return remove_weakly_dominated(
+        sol, [&](std::size_t to, std::size_t from) { payload[to] = std::move(payload[from]); },
+        [&](std::size_t size) { payload.resize(size); });
+  }
+
+ private:
+  std::pmr::vector<std::pmr::vector<T>> columns;  // One column per objective
+  std::size_t n = 0;                    // Number of points
+  bool is_maximization;
+
+  template <typename Move, typename Resize>
+  std::size_t remove_weakly_dominated(const std::vector<T>& sol, Move&& move, Resize&& resize) {
+    std::size_t kept = 0;
+    dominance_kernels::for_each_block(columns, n, sol, {!is_maximization, false}, [&](std::size_t base, std::size_t width, uint32_t mask) {
+      for (std::size_t j = 0; j < width; ++j) {
+        if (mask & (1u << j)) continue;
+        if (kept != base + j) {
+          for (auto& column : columns) {
+            column[kept] = column[base + j];
+          }
+          move(kept, base + j);
+        }
+        ++kept;
+      }
+      return true;
+    });
+    const std::size_t removed = n - kept;
+    for (auto& column : columns) {
+      column.resize(kept);
+    }
+    resize(kept);
+    n = kept;
+    return removed;
+  }
+
+  [[nodiscard]] bool any(const std::vector<T>& sol, const dominance_kernels::Query& query) const {
+    bool found = false;
+    dominance_kernels::for_each_block(columns, n, sol, query, [&](std::size_t, std::size_t, uint32_t mask) {
+      found = mask != 0;
+      return !found;
+    });
+    return found;
+  }
+};
+
+#endif  // DOMINANCE_ARCHIVE_HPP
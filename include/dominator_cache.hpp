@@ -0,0 +1,75 @@
+#ifndef DOMINATOR_CACHE_HPP
+#define DOMINATOR_CACHE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Queries answered by the dominator caches of the current thread. Per thread,
+// like the random engine, so that shared read-only caches can be queried
+// concurrently and each worker can account for its own queries.
+struct DominatorCacheCounters {
+  int64_t tests = 0;
+  int64_t hits = 0;
+};
+
+inline DominatorCacheCounters& dominator_cache_counters() {
+  thread_local DominatorCacheCounters counters;
+  return counters;
+}
+
+// A few points of an archive (maximization): the best one in each objective
+// and the latest insertions. Testing whether one of them weakly dominates a
+// point costs O(size * M), far less than a hypervolume contribution, and
+// proves that the contribution is 0. A cached point may have left the archive
+// since, but then a point of the archive dominates it, so a hit remains valid.
+template <typename T, typename Solution>
+class DominatorCache {
+ public:
+  static constexpr std::size_t n_recent = 8;
+
+  explicit DominatorCache(std::size_t n_objectives)
+      : m(n_objectives), rows((n_objectives + n_recent) * n_objectives, std::numeric_limits<T>::lowest()) {}
+
+  void insert(const Solution& p) {
+    for (std::size_t k = 0; k < m; ++k) {
+      if (p[k] > rows[k * m + k]) {
+        std::copy(p.begin(), p.end(), rows.begin() + k * m);
+      }
+    }
+    std::copy(p.begin(), p.end(), rows.begin() + (m + next_recent) * m);
+    next_recent = (next_recent + 1) % n_recent;
+  }
+
+  void clear() {
+    std::fill(rows.begin(), rows.end(), std::numeric_limits<T>::lowest());
+    next_recent = 0;
+  }
+
+  // True if a cached point weakly dominates p. Empty rows hold the lowest
+  // value and dominate nothing.
+  [[nodiscard]] bool dominates(const Solution& p) const {
+    DominatorCacheCounters& counters = dominator_cache_counters();
+    counters.tests++;
+    for (std::size_t row = 0; row < rows.size(); row += m) {
+      std::size_t k = 0;
+      while (k < m && rows[row + k] >= p[k]) {
+        k++;
+      }
+      if (k == m) {
+        counters.hits++;
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  std::size_t m;
+  std::vector<T> rows;  // Row k < m is the best point in objective k, then the recent points
+  std::size_t next_recent = 0;
+};
+
+#endif  // DOMINATOR_CACHE_HPP
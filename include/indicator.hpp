@@ -1,41 +1,227 @@
 #ifndef INDICATOR_HPP
 #define INDICATOR_HPP
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <dominance_archive.hpp>
+#include <dominator_cache.hpp>
+#include <map>
 #include <mooutils/indicators.hpp>
+#include <numeric>
+#include <staircase.hpp>
+#include <type_traits>
 #include <vector>
 
+// With 2 objectives the points are kept in a Staircase2D instead of the
+// generic mooutils structure, unless HYPER_GRASP_GENERIC_HV is defined (e.g.
+// to benchmark one against the other).
+//
+// With 4 or more objectives, exact contributions get expensive as the archive
+// grows. If samples is positive, contribution() instead returns a Monte Carlo
+// estimate from a fixed set of quasi-random (Halton) points in a box that holds
+// the exclusive region of the queried point. The samples are the same for
+// every query, so the estimate is a deterministic function of the point and
+// the archive, and it is 0 exactly when the point is weakly dominated. value()
+// stays exact.
+//
+// Outside the staircase, a query first goes through a DominatorCache, which
+// returns 0 for most dominated points (e.g. the bounds of candidates late in a
+// run) without computing their contribution.
 template <typename T, typename Solution>
 class HypervolumeIndicator {
  public:
-  HypervolumeIndicator(Solution ref_point, bool is_maximization = true)
+  HypervolumeIndicator(Solution ref_point, bool is_maximization = true, std::size_t samples = 0)
       : ref_point(ref_point),
         is_maximization(is_maximization),
-        hv_space(initialize_hv_space(ref_point, is_maximization)) {}
+        planar(use_staircase(ref_point)),
+        hv_space(initialize_hv_space(ref_point, is_maximization)),
+        staircase(is_maximization ? ref_point : negative_vector(ref_point)),
+        estimated(samples > 0 && ref_point.size() >= 4),
+        space_ref(is_maximization ? ref_point : negative_vector(ref_point)),
+        points(ref_point.size()),
+        cache(ref_point.size()),
+        unit_samples(estimated ? halton(samples, ref_point.size()) : std::vector<double>{}) {}
 
   T insert(const Solution& sol) {
     Solution aux_sol = is_maximization ? sol : negative_vector(sol);
-    return hv_space.insert(aux_sol);
+    return insert_point(aux_sol);
   }
 
   T contribution(const Solution& sol) const {
-    Solution aux_sol = is_maximization ? sol : negative_vector(sol);
-    return hv_space.contribution(aux_sol);
+    if (is_maximization) {
+      return contribution_point(sol);
+    }
+    // Queries are frequent, so the negated point reuses a per-thread buffer
+    thread_local Solution aux_sol;
+    aux_sol.resize(sol.size());
+    std::transform(sol.begin(), sol.end(), aux_sol.begin(), std::negate<T>());
+    return contribution_point(aux_sol);
+  }
+
+  // True if contribution() returns estimates
+  [[nodiscard]] bool is_estimated() const {
+    return estimated;
   }
 
   T value() const {
-    return hv_space.value();
+    return planar ? staircase.value() : hv_space.value();
   }
 
-  T set_hvc(const std::vector<Solution>& solutions) {
+  // Insert a batch of solutions and return their joint contribution. The batch
+  // is inserted by decreasing objective sum so that a point never removes a
+  // point of the same batch that was inserted before it.
+  T insert(const std::vector<Solution>& solutions) {
+    std::vector<Solution> batch = normalize(solutions, is_maximization);
+    std::vector<T> sums(batch.size());
+    std::transform(batch.begin(), batch.end(), sums.begin(), [](const Solution& sol) {
+      return std::accumulate(sol.begin(), sol.end(), T(0));
+    });
+    std::vector<std::size_t> order(batch.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+      return sums[a] > sums[b];
+    });
     T hvc = 0;
-    for (const Solution& sol : solutions) {
-      hvc += insert(sol);
+    for (std::size_t i : order) {
+      hvc += insert_point(batch[i]);
     }
     return hvc;
   }
 
+  T set_hvc(const std::vector<Solution>& solutions) {
+    return insert(solutions);
+  }
+
+  // Replace the points with solutions. Points cannot be removed from the
+  // incremental structure, so it is rebuilt (e.g. after pruning the archive).
+  T reset(const std::vector<Solution>& solutions) {
+    hv_space = initialize_hv_space(ref_point, is_maximization);
+    staircase = Staircase2D<T, Solution>(space_ref);
+    points.clear();
+    cache.clear();
+    return insert(solutions);
+  }
+
+  // Hypervolume of a set of solutions computed from scratch. Uses an
+  // O(n log n) sweep for 2 and 3 objectives and incremental insertion otherwise.
+  static T compute(const Solution& ref_point, const std::vector<Solution>& solutions, bool is_maximization = true) {
+    const Solution ref = is_maximization ? ref_point : negative_vector(ref_point);
+    std::vector<Solution> points;
+    points.reserve(solutions.size());
+    for (const Solution& sol : normalize(solutions, is_maximization)) {
+      bool inside = true;
+      for (std::size_t i = 0; i < ref.size() && inside; ++i) {
+        inside = sol[i] > ref[i];
+      }
+      if (inside) {
+        points.push_back(sol);
+      }
+    }
+    if (ref.size() == 2) {
+      return sweep_2d(ref, points);
+    } else if (ref.size() == 3) {
+      return sweep_3d(ref, points);
+    }
+    return HypervolumeIndicator(ref, true).insert(points);
+  }
+
  private:
+  // Points in the maximization space
+  T insert_point(const Solution& p) {
+    if (planar) {
+      return staircase.insert(p);
+    }
+    const T hvc = hv_space.insert(p);
+    if (hvc > 0) {
+      cache.insert(p);
+    }
+    if (estimated && hvc > 0) {
+      points.remove_weakly_dominated(p);
+      points.push_back(p);
+    }
+    return hvc;
+  }
+
+  T contribution_point(const Solution& p) const {
+    if (planar) {
+      return staircase.contribution(p);
+    }
+    if (cache.dominates(p)) {
+      return 0;
+    }
+    return estimated ? estimate(p) : hv_space.contribution(p);
+  }
+
+  // Volume of the box that holds the exclusive region of p, times the fraction
+  // of the samples in it that no point weakly dominates
+  T estimate(const Solution& p) const {
+    const std::size_t m = p.size();
+    for (std::size_t k = 0; k < m; ++k) {
+      if (p[k] <= space_ref[k]) {
+        return 0;
+      }
+    }
+    if (!points.is_non_dominated(p)) {
+      return 0;
+    }
+    thread_local Solution lower, sample;
+    lower = space_ref;
+    points.tighten_exclusive_corner(p, lower);
+    double box = 1;
+    for (std::size_t k = 0; k < m; ++k) {
+      box *= static_cast<double>(p[k] - lower[k]);
+    }
+    if (points.empty()) {
+      return static_cast<T>(box);
+    }
+    sample.resize(m);
+    const std::size_t n_samples = unit_samples.size() / m;
+    std::size_t uncovered = 0;
+    for (std::size_t s = 0; s < n_samples; ++s) {
+      for (std::size_t k = 0; k < m; ++k) {
+        const double x = static_cast<double>(lower[k]) + unit_samples[s * m + k] * static_cast<double>(p[k] - lower[k]);
+        // With integer objectives, x is dominated by q iff ceil(x) is
+        sample[k] = std::is_integral_v<T> ? static_cast<T>(std::ceil(x)) : static_cast<T>(x);
+      }
+      uncovered += points.is_non_dominated(sample);
+    }
+    // p is not dominated, so its contribution is positive even if no sample shows it
+    return std::max(static_cast<T>(box * uncovered / n_samples), static_cast<T>(1));
+  }
+
+  // First n points of the Halton sequence in the unit cube of dimension m,
+  // flattened, shifted by 1/2 modulo 1. Without the shift the first points
+  // leave a gap next to 1, i.e. next to the queried point, where most of the
+  // exclusive region usually is.
+  static std::vector<double> halton(std::size_t n, std::size_t m) {
+    std::vector<uint32_t> primes;
+    for (uint32_t candidate = 2; primes.size() < m; ++candidate) {
+      if (std::none_of(primes.begin(), primes.end(), [&](uint32_t prime) { return candidate % prime == 0; })) {
+        primes.push_back(candidate);
+      }
+    }
+    std::vector<double> unit(n * m);
+    for (std::size_t i = 0; i < n; ++i) {
+      for (std::size_t k = 0; k < m; ++k) {
+        double inverse = 0, scale = 1.0 / primes[k];
+        for (std::size_t index = i + 1; index > 0; index /= primes[k], scale /= primes[k]) {
+          inverse += static_cast<double>(index % primes[k]) * scale;
+        }
+        unit[i * m + k] = inverse < 0.5 ? inverse + 0.5 : inverse - 0.5;
+      }
+    }
+    return unit;
+  }
+
+  static bool use_staircase(const Solution& ref_point) {
+#ifdef HYPER_GRASP_GENERIC_HV
+    return false;
+#else
+    return ref_point.size() == 2;
+#endif
+  }
+
   static mooutils::incremental_hv<T, Solution> initialize_hv_space(const Solution& ref_point, bool is_maximization) {
     return is_maximization ? mooutils::incremental_hv<T, Solution>(ref_point)
                            : mooutils::incremental_hv<T, Solution>(negative_vector(ref_point));
@@ -47,9 +233,81 @@ class HypervolumeIndicator {
     return res;
   }
 
+  static std::vector<Solution> normalize(const std::vector<Solution>& solutions, bool is_maximization) {
+    if (is_maximization) {
+      return solutions;
+    }
+    std::vector<Solution> res;
+    res.reserve(solutions.size());
+    for (const Solution& sol : solutions) {
+      res.push_back(negative_vector(sol));
+    }
+    return res;
+  }
+
+  // Points sorted by decreasing x; each point above the current maximum y adds
+  // a horizontal strip to the dominated region
+  static T sweep_2d(const Solution& ref, std::vector<Solution>& points) {
+    std::sort(points.begin(), points.end(), [](const Solution& a, const Solution& b) {
+      return a[0] != b[0] ? a[0] > b[0] : a[1] > b[1];
+    });
+    T hv = 0;
+    T max_y = ref[1];
+    for (const Solution& p : points) {
+      if (p[1] > max_y) {
+        hv += (p[0] - ref[0]) * (p[1] - max_y);
+        max_y = p[1];
+      }
+    }
+    return hv;
+  }
+
+  // Points sorted by decreasing z are added to a 2D staircase (x increasing,
+  // y decreasing) whose area is updated incrementally; each slab between two
+  // consecutive z values contributes area * height
+  static T sweep_3d(const Solution& ref, std::vector<Solution>& points) {
+    std::sort(points.begin(), points.end(), [](const Solution& a, const Solution& b) {
+      return a[2] > b[2];
+    });
+    std::map<T, T> staircase;
+    T area = 0;
+    T hv = 0;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+      const T x = points[i][0];
+      const T y = points[i][1];
+      auto it = staircase.lower_bound(x);
+      if (it == staircase.end() || it->second < y) {
+        // Not dominated in the (x, y) projection: remove the points it dominates
+        it = staircase.upper_bound(x);
+        T floor = it != staircase.end() ? it->second : ref[1];
+        T right = x;
+        while (it != staircase.begin() && std::prev(it)->second <= y) {
+          auto dominated = std::prev(it);
+          area += (right - dominated->first) * (y - floor);
+          floor = dominated->second;
+          right = dominated->first;
+          staircase.erase(dominated);
+        }
+        const T left = it != staircase.begin() ? std::prev(it)->first : ref[0];
+        area += (right - left) * (y - floor);
+        staircase.emplace_hint(it, x, y);
+      }
+      const T next_z = i + 1 < points.size() ? points[i + 1][2] : ref[2];
+      hv += area * (points[i][2] - next_z);
+    }
+    return hv;
+  }
+
   const Solution ref_point;
   const bool is_maximization;
+  const bool planar;  // 2 objectives, the staircase is used
   mooutils::incremental_hv<T, Solution> hv_space;
+  Staircase2D<T, Solution> staircase;
+  const bool estimated;              // 4+ objectives and samples, contributions are estimated
+  const Solution space_ref;          // Reference point in the maximization space
+  DominanceArchive<T> points;        // Nondominated points, only kept if estimated
+  DominatorCache<T, Solution> cache;  // Proves dominance before the contribution is computed
+  std::vector<double> unit_samples;  // Halton points, flattened
 };
 
 #endif  // INDICATOR_HPP
@@ -0,0 +1,39 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Run body(i) for every i in [0, n), spreading the indices over at most one
+// thread per hardware thread. Used for independent per-objective work such as
+// sorting and bounds during preprocessing. body must not throw.
+template <typename Body>
+inline void parallel_for(const std::size_t& n, Body&& body) {
+  const std::size_t n_threads = std::min<std::size_t>(n, std::max(1u, std::thread::hardware_concurrency()));
+  if (n_threads <= 1) {
+    for (std::size_t i = 0; i < n; ++i) {
+      body(i);
+    }
+    return;
+  }
+  std::atomic<std::size_t> next{0};
+  auto worker = [&]() {
+    for (std::size_t i = next++; i < n; i = next++) {
+      body(i);
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(n_threads - 1);
+  for (std::size_t t = 1; t < n_threads; ++t) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+#endif  // PARALLEL_HPP
@@ -0,0 +1,34 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+// Random numbers of the solver and the problems. Every thread has its own
+// engine, seeded at the start of each solve, so that solves on different
+// threads do not interfere and each one is reproducible from its seed.
+namespace rng {
+
+inline std::mt19937_64& engine() {
+  thread_local std::mt19937_64 engine(0);
+  return engine;
+}
+
+inline void seed(uint64_t seed) {
+  engine().seed(seed);
+}
+
+// Uniform integer in [0, n), n must be positive
+inline std::size_t index(std::size_t n) {
+  return std::uniform_int_distribution<std::size_t>(0, n - 1)(engine());
+}
+
+// Uniform double in [0, 1)
+inline double uniform() {
+  return std::uniform_real_distribution<double>(0.0, 1.0)(engine());
+}
+
+}  // namespace rng
+
+#endif  // RANDOM_HPP
@@ -0,0 +1,117 @@
+#ifndef REACTIVE_ALPHA_HPP
+#define REACTIVE_ALPHA_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random.hpp>
+#include <stdexcept>
+#include <vector>
+#ifdef __linux__
+#include <time.h>
+#endif
+
+// CPU time of the calling thread, in seconds, to score the alphas. Unlike
+// std::clock it does not count the other threads of the process (e.g.
+// concurrent solves). Falls back to wall time where the clock is missing.
+class ThreadCpuClock {
+ public:
+  static double now() {
+#if defined(__linux__) && defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+#else
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+  }
+};
+
+// Reactive GRASP: keeps a discrete set of alpha values and samples them with
+// probabilities proportional to the hypervolume gained per CPU-second by
+// the iterations that used each value.
+class ReactiveAlpha {
+ public:
+  ReactiveAlpha(std::vector<double> alphas, int32_t update_interval = 20, double min_probability = 0.02)
+      : alphas(alphas),
+        update_interval(update_interval),
+        min_probability(std::min(min_probability, 1.0 / alphas.size())),
+        probabilities(alphas.size(), 1.0 / alphas.size()),
+        hv_gain(alphas.size(), 0.0),
+        cpu_time(alphas.size(), 0.0),
+        samples(alphas.size(), 0) {
+    if (alphas.empty()) {
+      throw std::invalid_argument("Reactive alpha needs at least one alpha value");
+    }
+  }
+
+  [[nodiscard]] std::size_t sample() const {
+    double r = rng::uniform();
+    for (std::size_t k = 0; k < probabilities.size(); ++k) {
+      r -= probabilities[k];
+      if (r < 0) {
+        return k;
+      }
+    }
+    return probabilities.size() - 1;
+  }
+
+  [[nodiscard]] double alpha(std::size_t k) const {
+    return alphas[k];
+  }
+
+  [[nodiscard]] const std::vector<double>& getAlphas() const {
+    return alphas;
+  }
+
+  [[nodiscard]] const std::vector<double>& getProbabilities() const {
+    return probabilities;
+  }
+
+  // Record the outcome of an iteration that used alphas[k]
+  void update(std::size_t k, int64_t gain, double cpu_seconds) {
+    hv_gain[k] += static_cast<double>(gain);
+    cpu_time[k] += cpu_seconds;
+    samples[k] += 1;
+    if (++iterations % update_interval == 0) {
+      updateProbabilities();
+    }
+  }
+
+ private:
+  const std::vector<double> alphas;
+  const int32_t update_interval;  // Iterations between probability updates
+  const double min_probability;   // Every alpha keeps at least this probability
+  std::vector<double> probabilities;
+  std::vector<double> hv_gain;   // Total hypervolume gain per alpha
+  std::vector<double> cpu_time;  // Total CPU seconds per alpha
+  std::vector<int64_t> samples;  // Number of iterations per alpha
+  int64_t iterations = 0;
+
+  void updateProbabilities() {
+    std::vector<double> scores(alphas.size(), 0.0);
+    double best = 0.0;
+    for (std::size_t k = 0; k < alphas.size(); ++k) {
+      if (samples[k] == 0) continue;
+      // Clock resolution can make very short iterations cost zero seconds
+      scores[k] = cpu_time[k] > 0 ? hv_gain[k] / cpu_time[k] : hv_gain[k];
+      best = std::max(best, scores[k]);
+    }
+    // Alphas that were never sampled are scored optimistically
+    for (std::size_t k = 0; k < alphas.size(); ++k) {
+      if (samples[k] == 0) {
+        scores[k] = best;
+      }
+    }
+    double total = 0.0;
+    for (const double& score : scores) {
+      total += score;
+    }
+    const double free_mass = 1.0 - min_probability * alphas.size();
+    for (std::size_t k = 0; k < alphas.size(); ++k) {
+      probabilities[k] = min_probability + free_mass * (total > 0 ? scores[k] / total : 1.0 / alphas.size());
+    }
+  }
+};
+
+#endif  // REACTIVE_ALPHA_HPP
@@ -0,0 +1,32 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <atomic>
+#include <memory>
+
+// Read-copy-update publication of an immutable value. Readers take the
+// current version and keep it alive for as long as they use it, so they may
+// work on a slightly stale version while writers build the next one aside and
+// publish it. A version is freed when its last reader releases it. The
+// pointer is an atomic shared_ptr, so there is no mutex; building a version
+// is the writer's cost, loading one only copies the pointer.
+template <typename T>
+class Snapshot {
+ public:
+  explicit Snapshot(std::shared_ptr<const T> initial) : current(std::move(initial)) {}
+
+  [[nodiscard]] std::shared_ptr<const T> load() const {
+    return current.load(std::memory_order_acquire);
+  }
+
+  // Returns the previous version, so that the caller chooses where it is
+  // freed if this was its last reference
+  std::shared_ptr<const T> publish(std::shared_ptr<const T> next) {
+    return current.exchange(std::move(next), std::memory_order_acq_rel);
+  }
+
+ private:
+  std::atomic<std::shared_ptr<const T>> current;
+};
+
+#endif  // SNAPSHOT_HPP
@@ -0,0 +1,90 @@
+#ifndef STAIRCASE_HPP
+#define STAIRCASE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Incremental hypervolume in 2 objectives (maximization). The nondominated
+// points form a staircase kept in a flat array sorted by decreasing x, so by
+// increasing y. A query locates the point by binary search and only visits
+// the points that it dominates, so contribution and insertion cost
+// O(log n + k) plus, for an insertion, shifting the tail of the array.
+template <typename T, typename Solution>
+class Staircase2D {
+ public:
+  explicit Staircase2D(const Solution& ref_point) : ref_x(ref_point[0]), ref_y(ref_point[1]) {}
+
+  [[nodiscard]] T value() const {
+    return total;
+  }
+
+  [[nodiscard]] std::size_t size() const {
+    return xs.size();
+  }
+
+  [[nodiscard]] T contribution(const Solution& sol) const {
+    const T x = sol[0], y = sol[1];
+    if (x <= ref_x || y <= ref_y) {
+      return 0;
+    }
+    const std::size_t first = partition(x);
+    // The last point with x' >= x has the largest y among them
+    T lower = first > 0 ? ys[first - 1] : ref_y;
+    if (lower >= y) {
+      return 0;
+    }
+    // Horizontal strips between consecutive points with x' < x, each already
+    // covered up to the x of the point above it
+    T hv = 0;
+    std::size_t j = first;
+    for (; j < xs.size() && ys[j] < y; ++j) {
+      hv += (x - xs[j]) * (ys[j] - lower);
+      lower = ys[j];
+    }
+    const T covered = j < xs.size() ? xs[j] : ref_x;
+    return hv + (x - covered) * (y - lower);
+  }
+
+  T insert(const Solution& sol) {
+    const T hvc = contribution(sol);
+    if (hvc <= 0) {
+      return 0;
+    }
+    const T x = sol[0], y = sol[1];
+    // The points dominated by sol are contiguous: possibly the last one with
+    // x' == x, then those with x' < x and y' <= y
+    std::size_t first = partition(x);
+    if (first > 0 && xs[first - 1] == x) {
+      first--;
+    }
+    std::size_t last = partition(x);
+    while (last < xs.size() && ys[last] <= y) {
+      last++;
+    }
+    if (first == last) {
+      xs.insert(xs.begin() + first, x);
+      ys.insert(ys.begin() + first, y);
+    } else {
+      xs[first] = x;
+      ys[first] = y;
+      xs.erase(xs.begin() + first + 1, xs.begin() + last);
+      ys.erase(ys.begin() + first + 1, ys.begin() + last);
+    }
+    total += hvc;
+    return hvc;
+  }
+
+ private:
+  T ref_x, ref_y;
+  std::vector<T> xs;  // Decreasing
+  std::vector<T> ys;  // Increasing
+  T total = 0;
+
+  // Index of the first point with x' < x
+  [[nodiscard]] std::size_t partition(const T& x) const {
+    return std::partition_point(xs.begin(), xs.end(), [&](const T& xi) { return xi >= x; }) - xs.begin();
+  }
+};
+
+#endif  // STAIRCASE_HPP
@@ -1,15 +1,49 @@
 #ifndef STATISTICS_HPP
 #define STATISTICS_HPP
 
+#include <decision_vector.hpp>
+#include <fstream>
 #include <indicator.hpp>
 #include <string>
 #include <tuple>
+#include <unordered_set>
 #include <vector>
 
+// Hash of an objective vector, used to match solutions against the nondominated set
+struct SolutionHash {
+  template <typename Solution>
+  std::size_t operator()(const Solution& sol) const {
+    std::size_t seed = sol.size();
+    for (const auto& val : sol) {
+      seed ^= std::hash<typename Solution::value_type>()(val) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+  }
+};
+
+// Work done by the constructive phase: the number of candidate lists built,
+// their total size and the time spent building them (bound evaluations and
+// hypervolume contributions), and how many bounds the dominator cache tested
+// and rejected before their contribution was computed
+struct CandidateCounters {
+  int64_t steps = 0;
+  int64_t candidates = 0;
+  double generation_time = 0;
+  int64_t cache_tests = 0;
+  int64_t cache_hits = 0;
+
+  [[nodiscard]] double average_candidates() const {
+    return steps > 0 ? static_cast<double>(candidates) / steps : 0.0;
+  }
+
+  [[nodiscard]] double cache_hit_rate() const {
+    return cache_tests > 0 ? static_cast<double>(cache_hits) / cache_tests : 0.0;
+  }
+};
+
 template <typename Problem, typename Solution>
 class Statistics {
  public:
-  Problem problem;
   std::vector<Solution> nondominated_set;
   std::vector<Solution> solutions;
   std::vector<std::tuple<double, int32_t, int64_t>> statistics;
@@ -18,38 +52,54 @@ class Statistics {
   int iterations;
   int skipped_iterations;
   bool is_maximization;
+  CandidateCounters counters;
+  std::vector<DecisionVector> decisions;  // Decision vector of each solution, if known
 
-  Statistics(Problem problem,
+  // Only the reference point and the nondominated set are kept from the
+  // problem. The indicators are computed on first use.
+  Statistics(const Problem& problem,
              std::vector<Solution> solutions,
              int64_t seed,
              std::vector<std::tuple<double, int32_t, int64_t>> statistics,
              double elapsed_time,
              int iterations,
              int skipped_iterations,
-             bool is_maximization) : problem(problem),
-                                     solutions(solutions),
-                                     seed(seed),
-                                     statistics(statistics),
+             bool is_maximization,
+             CandidateCounters counters = {},
+             std::vector<DecisionVector> decisions = {}) : nondominated_set(problem.getNondominatedSet()),
+                                     solutions(std::move(solutions)),
+                                     statistics(std::move(statistics)),
                                      elapsed_time(elapsed_time),
+                                     seed(seed),
                                      iterations(iterations),
                                      skipped_iterations(skipped_iterations),
-                                     is_maximization(is_maximization) {
-    solutions_set_hv = calculate_hv(problem.getReferencePoint(), this->solutions);
-    n_solutions = this->solutions.size();
-    nondominated_set = problem.getNondominatedSet();
-    if (!nondominated_set.empty()) {
-      n_nondominated_set = nondominated_set.size();
-      nondominated_set_hv = calculate_hv(problem.getReferencePoint(), nondominated_set);
-      ratio_hv = static_cast<double>(solutions_set_hv) / nondominated_set_hv;
-      Solution nadir_nset = compute_nadir_nset(nondominated_set);
-      nadir_nset_hv = calculate_hv(nadir_nset, nondominated_set);
-      nadir_set_hv = calculate_hv(nadir_nset, this->solutions);
-      ratio_nadir_hv = static_cast<double>(nadir_set_hv) / nadir_nset_hv;
-      n_matching = matching(nondominated_set, this->solutions);
-    }
+                                     is_maximization(is_maximization),
+                                     counters(counters),
+                                     decisions(std::move(decisions)),
+                                     reference_point(problem.getReferencePoint()) {}
+
+  int64_t get_solutions_set_hv() {
+    summarize();
+    return solutions_set_hv;
+  }
+
+  int64_t get_nondominated_set_hv() {
+    summarize();
+    return nondominated_set_hv;
+  }
+
+  double get_ratio_hv() {
+    summarize();
+    return ratio_hv;
+  }
+
+  int get_n_matching() {
+    summarize();
+    return n_matching;
   }
 
   std::string to_string() {
+    summarize();
     std::string stats_str;
     stats_str += std::to_string(seed) + "\n";
     for (const auto& stat : statistics) {
@@ -87,7 +137,25 @@ class Statistics {
     file.close();
   }
 
+  // One line per solution: its objective values, the number of decision
+  // variables set and their indices
+  void to_decisions_file(const std::string& filename) const {
+    std::ofstream file(filename);
+    for (std::size_t i = 0; i < solutions.size() && i < decisions.size(); ++i) {
+      for (const auto& val : solutions[i]) {
+        file << val << " ";
+      }
+      file << decisions[i].count();
+      decisions[i].for_each_set([&](std::size_t j) {
+        file << " " << j;
+      });
+      file << "\n";
+    }
+    file.close();
+  }
+
   void to_debug_file() {
+    summarize();
     std::ofstream file("debug.out");
     file << "Non-dominated set\n";
     for (const auto& sol : nondominated_set) {
@@ -118,20 +186,42 @@ class Statistics {
   }
 
  private:
+  Solution reference_point;
+  bool summarized = false;
   int n_nondominated_set = 0;
   int n_solutions = 0;
   int64_t nondominated_set_hv = 0;
-  int64_t solutions_set_hv;
+  int64_t solutions_set_hv = 0;
   double ratio_hv = 0;
   int64_t nadir_nset_hv = 0;
   int64_t nadir_set_hv = 0;
   double ratio_nadir_hv = 0;
   int n_matching = 0;
 
+  void summarize() {
+    if (summarized) {
+      return;
+    }
+    summarized = true;
+    solutions_set_hv = calculate_hv(reference_point, solutions);
+    n_solutions = solutions.size();
+    if (!nondominated_set.empty()) {
+      n_nondominated_set = nondominated_set.size();
+      nondominated_set_hv = calculate_hv(reference_point, nondominated_set);
+      ratio_hv = static_cast<double>(solutions_set_hv) / nondominated_set_hv;
+      Solution nadir_nset = compute_nadir_nset(nondominated_set);
+      nadir_nset_hv = calculate_hv(nadir_nset, nondominated_set);
+      nadir_set_hv = calculate_hv(nadir_nset, solutions);
+      ratio_nadir_hv = static_cast<double>(nadir_set_hv) / nadir_nset_hv;
+      n_matching = matching(nondominated_set, solutions);
+    }
+  }
+
   int matching(const std::vector<Solution>& nondominated_set, const std::vector<Solution>& solutions) const {
+    const std::unordered_set<Solution, SolutionHash> nondominated(nondominated_set.begin(), nondominated_set.end());
     int matching = 0;
     for (const auto& sol : solutions) {
-      if (std::find(nondominated_set.begin(), nondominated_set.end(), sol) != nondominated_set.end()) {
+      if (nondominated.count(sol)) {
         matching++;
       }
     }
@@ -140,9 +230,9 @@ class Statistics {
 
   Solution compute_nadir_nset(const std::vector<Solution>& nondominated_set) const {
     if (nondominated_set.empty()) {
-      return problem.getReferencePoint();
+      return reference_point;
     }
-    Solution nadir = problem.emptySolution();
+    Solution nadir(reference_point.size(), 0);
     if (is_maximization) {
       for (auto& val : nadir) {
         val = std::numeric_limits<int64_t>::max();
@@ -165,7 +255,7 @@ class Statistics {
   }
 
   int64_t calculate_hv(const Solution& ref_point, const std::vector<Solution>& solutions) const {
-    return HypervolumeIndicator<int64_t, Solution>(ref_point, is_maximization).set_hvc(solutions);
+    return HypervolumeIndicator<int64_t, Solution>::compute(ref_point, solutions, is_maximization);
   }
 };
 
@@ -1,9 +1,32 @@
 #ifndef STOPPING_CRITERIA_HPP
 #define STOPPING_CRITERIA_HPP
 
+#include <algorithm>
 #include <chrono>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <time.h>
+#endif
+
+// Clock for the stopping criteria, which are queried on every iteration.
+// On Linux it reads CLOCK_MONOTONIC_COARSE, which costs a memory read instead
+// of a timer read and has a resolution of a few milliseconds.
+class CoarseClock {
+ public:
+  static double now() {
+#if defined(__linux__) && defined(CLOCK_MONOTONIC_COARSE)
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+#else
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+  }
+};
 
 class StoppingCriteria {
  public:
@@ -15,7 +38,18 @@ class StoppingCriteria {
   virtual bool shouldRetrieve() const = 0;
   virtual void resetRetrieveCriteria() = 0;
 
-  static StoppingCriteria* create(const std::string& criteria, double limit);
+  // Hypervolume of the archive, reported after every iteration
+  virtual void update(double /* hypervolume */) {}
+
+  // Criteria that compare against the known nondominated set ask for its
+  // hypervolume, which is only computed when needed
+  virtual bool needsKnownHypervolume() const {
+    return false;
+  }
+  virtual void setKnownHypervolume(double /* hypervolume */) {}
+
+  // A retrieve_interval of 0 uses the default of the criteria
+  static StoppingCriteria* create(const std::string& criteria, double limit, double retrieve_interval = 0);
 };
 
 class TimeStoppingCriteria : public StoppingCriteria {
@@ -24,14 +58,12 @@ class TimeStoppingCriteria : public StoppingCriteria {
       : time_limit(time_limit), retrieve_interval(retrieve_interval) {}
 
   void start() override {
-    start_time = std::chrono::high_resolution_clock::now();
+    start_time = CoarseClock::now();
     last_retrieve_time = start_time;
   }
 
   bool shouldStop() const override {
-    auto now = std::chrono::high_resolution_clock::now();
-    auto elapsed = std::chrono::duration<double>(now - start_time).count();
-    return elapsed >= time_limit;
+    return current() >= time_limit;
   }
 
   void increment() override {
@@ -39,25 +71,22 @@ class TimeStoppingCriteria : public StoppingCriteria {
   }
 
   double current() const override {
-    auto now = std::chrono::high_resolution_clock::now();
-    return std::chrono::duration<double>(now - start_time).count();
+    return CoarseClock::now() - start_time;
   }
 
   bool shouldRetrieve() const override {
-    auto now = std::chrono::high_resolution_clock::now();
-    auto elapsed = std::chrono::duration<double>(now - last_retrieve_time).count();
-    return elapsed >= retrieve_interval;
+    return CoarseClock::now() - last_retrieve_time >= retrieve_interval;
   }
 
   void resetRetrieveCriteria() override {
-    last_retrieve_time = std::chrono::high_resolution_clock::now();
+    last_retrieve_time = CoarseClock::now();
   }
 
  private:
   double time_limit;
   double retrieve_interval;
-  std::chrono::time_point<std::chrono::high_resolution_clock> start_time;
-  std::chrono::time_point<std::chrono::high_resolution_clock> last_retrieve_time;
+  double start_time = 0;
+  double last_retrieve_time = 0;
 };
 
 class IterationStoppingCriteria : public StoppingCriteria {
@@ -97,11 +126,189 @@ class IterationStoppingCriteria : public StoppingCriteria {
   int last_retrieve_iteration;
 };
 
-StoppingCriteria* StoppingCriteria::create(const std::string& criteria, double limit) {
+// Stops when the hypervolume has not improved for stagnation_time seconds
+class StagnationStoppingCriteria : public StoppingCriteria {
+ public:
+  StagnationStoppingCriteria(double stagnation_time, double retrieve_interval = 5)
+      : stagnation_time(stagnation_time), retrieve_interval(retrieve_interval) {}
+
+  void start() override {
+    start_time = CoarseClock::now();
+    last_improvement_time = start_time;
+    last_retrieve_time = start_time;
+    best_hypervolume = 0;
+  }
+
+  bool shouldStop() const override {
+    return CoarseClock::now() - last_improvement_time >= stagnation_time;
+  }
+
+  void increment() override {
+    // Do nothing
+  }
+
+  void update(double hypervolume) override {
+    if (hypervolume > best_hypervolume) {
+      best_hypervolume = hypervolume;
+      last_improvement_time = CoarseClock::now();
+    }
+  }
+
+  double current() const override {
+    return CoarseClock::now() - start_time;
+  }
+
+  bool shouldRetrieve() const override {
+    return CoarseClock::now() - last_retrieve_time >= retrieve_interval;
+  }
+
+  void resetRetrieveCriteria() override {
+    last_retrieve_time = CoarseClock::now();
+  }
+
+ private:
+  double stagnation_time;
+  double retrieve_interval;
+  double start_time = 0;
+  double last_improvement_time = 0;
+  double last_retrieve_time = 0;
+  double best_hypervolume = 0;
+};
+
+// Stops when the hypervolume reaches target_ratio times the hypervolume of
+// the known nondominated set (the ratio_hv of the statistics). Never stops if
+// the set is unknown.
+class TargetRatioStoppingCriteria : public StoppingCriteria {
+ public:
+  TargetRatioStoppingCriteria(double target_ratio, double retrieve_interval = 5)
+      : target_ratio(target_ratio), retrieve_interval(retrieve_interval) {}
+
+  void start() override {
+    start_time = CoarseClock::now();
+    last_retrieve_time = start_time;
+    ratio = 0;
+  }
+
+  bool shouldStop() const override {
+    return known_hypervolume > 0 && ratio >= target_ratio;
+  }
+
+  void increment() override {
+    // Do nothing
+  }
+
+  void update(double hypervolume) override {
+    ratio = known_hypervolume > 0 ? hypervolume / known_hypervolume : 0;
+  }
+
+  bool needsKnownHypervolume() const override {
+    return true;
+  }
+
+  void setKnownHypervolume(double hypervolume) override {
+    known_hypervolume = hypervolume;
+  }
+
+  double current() const override {
+    return CoarseClock::now() - start_time;
+  }
+
+  bool shouldRetrieve() const override {
+    return CoarseClock::now() - last_retrieve_time >= retrieve_interval;
+  }
+
+  void resetRetrieveCriteria() override {
+    last_retrieve_time = CoarseClock::now();
+  }
+
+ private:
+  double target_ratio;
+  double retrieve_interval;
+  double start_time = 0;
+  double last_retrieve_time = 0;
+  double known_hypervolume = 0;
+  double ratio = 0;
+};
+
+// Combination of criteria: stops when any of them (the earliest) or all of
+// them (the latest) would stop. The first criteria is the primary one, it
+// defines current() and when the statistics are retrieved.
+class CombinedStoppingCriteria : public StoppingCriteria {
+ public:
+  enum class Mode { Any,
+                    All };
+
+  CombinedStoppingCriteria(std::vector<std::unique_ptr<StoppingCriteria>> criteria, Mode mode = Mode::Any)
+      : criteria(std::move(criteria)), mode(mode) {
+    if (this->criteria.empty()) {
+      throw std::invalid_argument("Combined criteria needs at least one criteria");
+    }
+  }
+
+  void start() override {
+    for (auto& c : criteria) {
+      c->start();
+    }
+  }
+
+  bool shouldStop() const override {
+    auto stops = [](const std::unique_ptr<StoppingCriteria>& c) {
+      return c->shouldStop();
+    };
+    return mode == Mode::Any ? std::any_of(criteria.begin(), criteria.end(), stops)
+                             : std::all_of(criteria.begin(), criteria.end(), stops);
+  }
+
+  void increment() override {
+    for (auto& c : criteria) {
+      c->increment();
+    }
+  }
+
+  void update(double hypervolume) override {
+    for (auto& c : criteria) {
+      c->update(hypervolume);
+    }
+  }
+
+  bool needsKnownHypervolume() const override {
+    return std::any_of(criteria.begin(), criteria.end(), [](const std::unique_ptr<StoppingCriteria>& c) {
+      return c->needsKnownHypervolume();
+    });
+  }
+
+  void setKnownHypervolume(double hypervolume) override {
+    for (auto& c : criteria) {
+      c->setKnownHypervolume(hypervolume);
+    }
+  }
+
+  double current() const override {
+    return criteria.front()->current();
+  }
+
+  bool shouldRetrieve() const override {
+    return criteria.front()->shouldRetrieve();
+  }
+
+  void resetRetrieveCriteria() override {
+    criteria.front()->resetRetrieveCriteria();
+  }
+
+ private:
+  std::vector<std::unique_ptr<StoppingCriteria>> criteria;
+  Mode mode;
+};
+
+inline StoppingCriteria* StoppingCriteria::create(const std::string& criteria, double limit, double retrieve_interval) {
   if (criteria == "time") {
-    return new TimeStoppingCriteria(limit);
+    return new TimeStoppingCriteria(limit, retrieve_interval > 0 ? retrieve_interval : 5);
   } else if (criteria == "iterations") {
-    return new IterationStoppingCriteria(static_cast<int>(limit));
+    return new IterationStoppingCriteria(static_cast<int>(limit), retrieve_interval > 0 ? retrieve_interval : 50);
+  } else if (criteria == "stagnation") {
+    return new StagnationStoppingCriteria(limit, retrieve_interval > 0 ? retrieve_interval : 5);
+  } else if (criteria == "target-ratio") {
+    return new TargetRatioStoppingCriteria(limit, retrieve_interval > 0 ? retrieve_interval : 5);
   } else {
     throw std::invalid_argument("Invalid criteria: " + criteria);
   }
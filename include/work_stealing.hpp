@@ -0,0 +1,146 @@
+#ifndef WORK_STEALING_HPP
+#define WORK_STEALING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Task scheduler for work of very uneven cost (e.g. GRASP constructions that
+// are skipped next to long local searches). Every worker owns a deque: it
+// pushes and pops its own tasks at the back, so it continues the work it just
+// produced, and idle workers steal the oldest task at the front of another
+// worker's deque. Workers that find nothing to do sleep until a task is
+// pushed, with a timed wait as a fallback. Tasks receive the index of the
+// worker that runs them and may push more tasks; run() returns when every
+// task has finished.
+class WorkStealingScheduler {
+ public:
+  using Task = std::function<void(std::size_t)>;
+
+  explicit WorkStealingScheduler(std::size_t n_workers) : deques(std::max<std::size_t>(n_workers, 1)) {
+    for (auto& deque : deques) {
+      deque = std::make_unique<Deque>();
+    }
+  }
+
+  [[nodiscard]] std::size_t size() const {
+    return deques.size();
+  }
+
+  // Queue a task on the deque of worker
+  void push(std::size_t worker, Task task) {
+    pending.fetch_add(1, std::memory_order_relaxed);
+    {
+      Deque& deque = *deques[worker];
+      std::lock_guard<std::mutex> lock(deque.mutex);
+      deque.tasks.push_back(std::move(task));
+    }
+    pushes.fetch_add(1);
+    wake(false);
+  }
+
+  // Run the queued tasks, and the tasks they push, on size() threads (the
+  // caller is worker 0). Tasks must not throw.
+  void run() {
+    std::vector<std::thread> threads;
+    threads.reserve(deques.size() - 1);
+    for (std::size_t w = 1; w < deques.size(); ++w) {
+      threads.emplace_back([this, w] { work(w); });
+    }
+    work(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+ private:
+  struct Deque {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<Deque>> deques;
+  std::atomic<std::size_t> pending{0};  // Tasks queued or running
+  std::atomic<std::size_t> pushes{0};   // Tasks ever pushed, tells sleepers that something changed
+  std::atomic<std::size_t> sleepers{0};
+  std::mutex idle_mutex;
+  std::condition_variable idle;
+
+  // Wake one sleeper (a task was pushed) or all of them (the run is over).
+  // Taking the mutex orders the wake after a sleeper's last check.
+  void wake(bool all) {
+    if (sleepers.load() == 0) {
+      return;
+    }
+    { std::lock_guard<std::mutex> lock(idle_mutex); }
+    if (all) {
+      idle.notify_all();
+    } else {
+      idle.notify_one();
+    }
+  }
+
+  std::optional<Task> pop(std::size_t worker) {
+    Deque& deque = *deques[worker];
+    std::lock_guard<std::mutex> lock(deque.mutex);
+    if (deque.tasks.empty()) {
+      return std::nullopt;
+    }
+    Task task = std::move(deque.tasks.back());
+    deque.tasks.pop_back();
+    return task;
+  }
+
+  std::optional<Task> steal(std::size_t thief) {
+    for (std::size_t k = 1; k < deques.size(); ++k) {
+      Deque& deque = *deques[(thief + k) % deques.size()];
+      std::lock_guard<std::mutex> lock(deque.mutex);
+      if (!deque.tasks.empty()) {
+        Task task = std::move(deque.tasks.front());
+        deque.tasks.pop_front();
+        return task;
+      }
+    }
+    return std::nullopt;
+  }
+
+  void work(std::size_t worker) {
+    std::chrono::microseconds backoff(50);
+    while (pending.load(std::memory_order_acquire) > 0) {
+      const std::size_t seen = pushes.load();
+      std::optional<Task> task = pop(worker);
+      if (!task) {
+        task = steal(worker);
+      }
+      if (!task) {
+        // Everything left is running elsewhere and may still push tasks.
+        // Sleep until a push or the end of the run; the timeout only
+        // guards against a missed wake.
+        sleepers.fetch_add(1);
+        {
+          std::unique_lock<std::mutex> lock(idle_mutex);
+          idle.wait_for(lock, backoff, [&] { return pushes.load() != seen || pending.load() == 0; });
+        }
+        sleepers.fetch_sub(1);
+        backoff = std::min(2 * backoff, std::chrono::microseconds(5000));
+        continue;
+      }
+      backoff = std::chrono::microseconds(50);
+      (*task)(worker);
+      if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        wake(true);
+      }
+    }
+  }
+};
+
+#endif  // WORK_STEALING_HPP
@@ -2,25 +2,60 @@
 #define MOKP_HPP
 
 #include <algorithm>
+#include <condition_variable>
 #include <cstdint>
 #include <dominance.hpp>
+#include <dominance_archive.hpp>
 #include <indicator.hpp>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <numeric>
+#include <parallel.hpp>
 #include <problem_base.hpp>
+#include <random.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <utility>
 #include <vector>
 
 struct Item {
  public:
-  int32_t idx;                  // Index of the item
-  int64_t weight;               // Weight of the item
-  std::vector<int64_t> values;  // Values of the item for each objective
+  int32_t idx;                   // Index of the item
+  int64_t weight;                // Surrogate weight of the item (the weight itself with one constraint)
+  std::vector<int64_t> weights;  // Weights of the item for each constraint
+  std::vector<int64_t> values;   // Values of the item for each objective
+
+  Item(int idx, std::vector<int64_t> weights, std::vector<int64_t> values, const std::vector<int64_t>& multipliers)
+      : idx(idx), weight(0), weights(weights), values(values) {
+    for (int d = 0; d < (int)weights.size(); d++) {
+      weight += multipliers[d] * weights[d];
+    }
+  }
 
-  Item(int idx, int64_t weight, std::vector<int64_t> values)
-      : idx(idx), weight(weight), values(values) {}
+  // True if the item fits in the remaining capacity of every constraint
+  template <typename Capacities>
+  bool fits(const Capacities& remaining) const {
+    for (int d = 0; d < (int)weights.size(); d++) {
+      if (weights[d] > remaining[d]) {
+        return false;
+      }
+    }
+    return true;
+  }
 
   std::string to_string() const {
-    std::string str = "Item(" + std::to_string(idx) + ", " + std::to_string(weight) + ", [";
+    std::string str = "Item(" + std::to_string(idx) + ", [";
+    for (int d = 0; d < (int)weights.size(); d++) {
+      str += std::to_string(weights[d]);
+      if (d < (int)weights.size() - 1) {
+        str += ", ";
+      }
+    }
+    str += "], [";
     for (int i = 0; i < (int)values.size(); i++) {
       str += std::to_string(values[i]);
       if (i < (int)values.size() - 1) {
@@ -32,18 +67,25 @@ struct Item {
   }
 };
 
+// Bound used to score the candidates:
+// - Dantzig: LP relaxation of the knapsack
+// - MartelloToth: U2 bound, the best of the LP relaxations with the break item
+//   excluded or forced in. It is never looser than Dantzig.
+// Items sorted by decreasing ratio values[i]/weight, one order per objective.
+// Computed once and shared between the problem and its upper bound.
+using SortedItems = std::vector<std::vector<Item>>;
+
+enum class BoundType { Dantzig,
+                       MartelloToth };
+
+// Upper bound of the knapsack for each objective, updated incrementally
+// as items are added. With several constraints it bounds the surrogate
+// relaxation, i.e. the knapsack with the surrogate weights and capacity.
 struct UpperBound {
  public:
-  UpperBound(const std::vector<Item>& items, int32_t M, int64_t W) : items(items), N(items.size()), M(M), W(W) {
-    // Pre-process the items and sort them by the ratio of values[i]/weight
-    this->sorted_items.resize(M);
-    for (int i = 0; i < M; i++) {
-      this->sorted_items[i] = items;
-      // Sort the items by the ratio of values[i]/weight
-      std::sort(sorted_items[i].begin(), sorted_items[i].end(), [i](const Item& a, const Item& b) {
-        return (a.values[i] / (double)a.weight) > (b.values[i] / (double)b.weight);
-      });
-    }
+  UpperBound(const std::vector<Item>& items, std::shared_ptr<const SortedItems> sorted_orders, int32_t M, int64_t W,
+             BoundType bound = BoundType::Dantzig)
+      : items(items), N(items.size()), M(M), W(W), bound(bound), sorted_orders(sorted_orders), sorted_items(*sorted_orders) {
     // Compute the upper bound positions
     this->ub_positions.resize(M, std::vector<int32_t>(N, 0));
     for (int i = 0; i < M; i++) {
@@ -74,8 +116,12 @@ struct UpperBound {
     }
     // Compute the upper bound
     this->ub.resize(M, 0);
+    const std::vector<bool> no_used_items(N, false);
     for (int i = 0; i < M; i++) {
       ub[i] = ub_full[i] + ub_partial[i];
+      if (bound == BoundType::MartelloToth) {
+        ub[i] = martelloToth(no_used_items, -1, i, ub_full[i], ub_q[i], ub_m[i]);
+      }
     }
     // Save the default upper bounds
     this->default_ub_full = ub_full;
@@ -93,8 +139,7 @@ struct UpperBound {
     this->ub = this->default_ub;
   }
 
-  auto update_add_item(const std::vector<bool>& used_items, const int32_t item_idx) {
-    std::vector<int64_t> ub_aux = this->ub;
+  const std::vector<int64_t>& update_add_item(const std::vector<bool>& used_items, const int32_t item_idx) {
     for (int i = 0; i < this->M; i++) {
       if (this->ub_positions[i][item_idx] < this->ub_m[i]) continue;
       this->ub_q[i] -= this->items[item_idx].weight;
@@ -109,14 +154,23 @@ struct UpperBound {
         }
       }
       this->ub_partial[i] = (this->ub_q[i] * this->items[idx].values[i]) / this->items[idx].weight;
-      ub_aux[i] = this->ub_full[i] + this->ub_partial[i];
+      this->ub[i] = this->ub_full[i] + this->ub_partial[i];
+      if (this->bound == BoundType::MartelloToth) {
+        this->ub[i] = martelloToth(used_items, item_idx, i, this->ub_full[i], this->ub_q[i], this->ub_m[i]);
+      }
     }
-    this->ub = ub_aux;
-    return ub_aux;
+    return this->ub;
   }
 
   auto simulate_add_item(const std::vector<bool>& used_items, const int32_t item_idx) const {
-    std::vector<int64_t> ub_aux = this->ub;
+    std::vector<int64_t> ub_aux;
+    simulate_add_item(used_items, item_idx, ub_aux);
+    return ub_aux;
+  }
+
+  // Same as above, writing the bound into ub_aux to avoid an allocation per candidate
+  void simulate_add_item(const std::vector<bool>& used_items, const int32_t item_idx, std::vector<int64_t>& ub_aux) const {
+    ub_aux = this->ub;
     for (int i = 0; i < this->M; i++) {
       if (this->ub_positions[i][item_idx] < this->ub_m[i]) continue;
       int64_t ub_q = this->ub_q[i];
@@ -135,8 +189,10 @@ struct UpperBound {
       }
       int64_t ub_partial = (ub_q * this->items[idx].values[i]) / this->items[idx].weight;
       ub_aux[i] = ub_full + ub_partial;
+      if (this->bound == BoundType::MartelloToth) {
+        ub_aux[i] = martelloToth(used_items, item_idx, i, ub_full, ub_q, ub_m);
+      }
     }
-    return ub_aux;
   }
 
   std::string to_string() const {
@@ -155,8 +211,10 @@ struct UpperBound {
   const std::vector<Item> items;                   // Original items
   const int32_t N;                                 // Number of items
   const int32_t M;                                 // Number of objectives
-  const int64_t W;                                 // Maximum Knapsack weight
-  std::vector<std::vector<Item>> sorted_items;     // Items sorted by the ratio of values[i]/weight
+  const int64_t W;                                 // Maximum Knapsack (surrogate) weight
+  const BoundType bound;                           // Bound computed from the LP break point
+  std::shared_ptr<const SortedItems> sorted_orders;
+  const SortedItems& sorted_items;                 // Items sorted by the ratio of values[i]/weight
   std::vector<std::vector<int32_t>> ub_positions;  // Positions of the items in the sorted_items vector
   std::vector<int64_t> ub_full;                    // Upper bound for the full knapsack
   std::vector<int64_t> ub_partial;                 // Upper bound for the partial knapsack
@@ -169,52 +227,119 @@ struct UpperBound {
   std::vector<int64_t> default_ub_q;
   std::vector<int64_t> default_ub_m;
   std::vector<int64_t> default_ub;
+
+  // Martello-Toth U2 bound of objective i from the LP state (full, q, m). The
+  // items before position m that are free and the used items are in the
+  // knapsack, added_item is in the knapsack but not yet marked as used. Only
+  // the free items next to the break point are visited, so the cost is close
+  // to the one of the LP bound.
+  int64_t martelloToth(const std::vector<bool>& used_items, const int32_t added_item, const int32_t i,
+                       const int64_t full, const int64_t q, const int64_t m) const {
+    auto is_free = [&](const int64_t& j) {
+      const int32_t idx = this->sorted_items[i][j].idx;
+      return !used_items[idx] && idx != added_item;
+    };
+    // Break item: first free item that does not fit
+    int64_t s = m;
+    while (s < this->N && !is_free(s)) s++;
+    if (s == this->N) {
+      return full;
+    }
+    const Item& break_item = this->sorted_items[i][s];
+    const int64_t dantzig = full + (q * break_item.values[i]) / break_item.weight;
+    // U0: break item excluded, the residual capacity is filled with the next free item
+    int64_t next = s + 1;
+    while (next < this->N && !is_free(next)) next++;
+    int64_t u0 = full;
+    if (next < this->N) {
+      u0 += (q * this->sorted_items[i][next].values[i]) / this->sorted_items[i][next].weight;
+    }
+    // U1: break item forced in, the missing capacity is removed from the previous free item
+    int64_t prev = m - 1;
+    while (prev >= 0 && !is_free(prev)) prev--;
+    int64_t u1 = u0;
+    if (prev >= 0) {
+      const Item& prev_item = this->sorted_items[i][prev];
+      const int64_t missing = break_item.weight - q;
+      u1 = full + break_item.values[i] - (missing * prev_item.values[i] + prev_item.weight - 1) / prev_item.weight;
+    }
+    return std::min(dantzig, std::max(u0, u1));
+  }
 };
 
 template <typename Solution, typename Candidate>
-class MOKP : public ProblemBase<Solution, Candidate> {
-  MOKP(int32_t N, int32_t M, int64_t W,
-       std::vector<int64_t> weights,
+class MOKP : public ProblemBase<MOKP<Solution, Candidate>, Solution, Candidate> {
+  MOKP(int32_t N, int32_t M, int32_t D,
+       std::vector<int64_t> W,
+       std::vector<int64_t> multipliers,
+       std::vector<std::vector<int64_t>> weights,
        std::vector<std::vector<int64_t>> values,
        std::vector<Item> items,
-       std::vector<Solution> nondominated_set)
+       std::vector<Solution> nondominated_set,
+       BoundType bound)
       : N(N),
         M(M),
+        D(D),
         W(W),
+        multipliers(multipliers),
         weights(weights),
         values(values),
         items(items),
         nondominated_set(nondominated_set),
-        current_upper_bound(items, M, W),
+        sorted_items_objectives(sortItemsObjectives(items, M)),
+        current_upper_bound(items, sorted_items_objectives, M, surrogate(W, multipliers), bound),
         current_solution(M, 0),
         current_used_items(N, false),
-        current_weight(W) {
+        current_weight(W),
+        candidate_upper_bound(M, 0) {
     // Initialize the reference point
     this->reference_point = std::vector<int64_t>(M, 0);
-    this->sorted_items_objectives = sortItemsObjectives(items);
   }
 
  public:
   template <typename IStream>
-  static auto from_stream(IStream&& is) -> MOKP {
-    // Read from file
-    int32_t N, M;
-    int64_t W;
-    is >> N >> M;
-    is >> W;
-    std::vector<int64_t> weights(N);
+  static auto from_stream(IStream&& is, BoundType bound = BoundType::Dantzig) -> MOKP {
+    // Read from file. The header is "N M" for a single constraint or
+    // "N M D" for D constraints.
+    int32_t N, M, D = 1;
+    std::string header;
+    while (header.find_first_not_of(" \t\r") == std::string::npos && std::getline(is, header)) {
+    }
+    std::istringstream header_stream(header);
+    if (!(header_stream >> N >> M) || N < 1 || M < 1) {
+      throw std::invalid_argument("Invalid MOKP header: N and M must be positive integers");
+    }
+    header_stream >> D;
+    if (header_stream.fail()) {
+      D = 1;
+    } else if (D < 1) {
+      throw std::invalid_argument("Invalid MOKP header: D must be at least 1, got " + std::to_string(D));
+    }
+    std::vector<int64_t> W(D);
+    for (int d = 0; d < D; d++) {
+      is >> W[d];
+    }
+    if (is.fail()) {
+      throw std::invalid_argument("Invalid MOKP instance: expected " + std::to_string(D) + " capacities");
+    }
+    std::vector<std::vector<int64_t>> weights(N, std::vector<int64_t>(D));
     std::vector<std::vector<int64_t>> values(N, std::vector<int64_t>(M));
     for (int i = 0; i < N; i++) {
-      is >> weights[i];
+      for (int d = 0; d < D; d++) {
+        is >> weights[i][d];
+      }
       for (int j = 0; j < M; j++) {
         is >> values[i][j];
       }
-      // is >> weights[i];
+      if (is.fail()) {
+        throw std::invalid_argument("Invalid MOKP instance: expected " + std::to_string(N) + " items, read " + std::to_string(i));
+      }
     }
-    // Pre-process the items and sort them by the ratio of values[i]/weight
+    // Pre-process the items, their surrogate weight aggregates the constraints
+    std::vector<int64_t> multipliers = surrogateMultipliers(W);
     std::vector<Item> items = std::vector<Item>();
     for (int i = 0; i < N; i++) {
-      items.push_back(Item(i, weights[i], values[i]));
+      items.push_back(Item(i, weights[i], values[i], multipliers));
     }
     // Read the nondominated set
     std::vector<Solution> nondominated_set;
@@ -228,96 +353,129 @@ class MOKP : public ProblemBase<Solution, Candidate> {
         }
       }
     }
-    return MOKP(N, M, W, weights, values, items, nondominated_set);
+    return MOKP(N, M, D, W, multipliers, weights, values, items, nondominated_set, bound);
   }
 
-  void reset() override {
+  void reset() {
+    // Reuse the existing storage, a reset must not allocate
     this->current_upper_bound.reset();
-    this->current_solution = std::vector<int64_t>(M, 0);
-    this->current_used_items = std::vector<bool>(N, false);
-    this->current_weight = W;
+    std::fill(this->current_solution.begin(), this->current_solution.end(), 0);
+    std::fill(this->current_used_items.begin(), this->current_used_items.end(), false);
+    std::copy(W.begin(), W.end(), this->current_weight.begin());
   }
 
-  [[nodiscard]] std::vector<Solution> getNondominatedSet() const {
+  [[nodiscard]] const std::vector<Solution>& getNondominatedSet() const {
     return this->nondominated_set;
   }
 
-  [[nodiscard]] std::vector<int64_t> getReferencePoint() const override {
+  [[nodiscard]] const Solution& getReferencePoint() const {
     return this->reference_point;
   }
 
-  [[nodiscard]] std::vector<Candidate> generateCandidates(const Solution& current_solution,
-                                                          const std::vector<Solution>& solution_set,
-                                                          const HypervolumeIndicator<int64_t, Solution>& hv_space) const override {
-    std::vector<Candidate> candidate_items;
+  void generateCandidates(const Solution& current_solution,
+                          const std::vector<Solution>& solution_set,
+                          const HypervolumeIndicator<int64_t, Solution>& hv_space,
+                          std::vector<Candidate>& candidate_items,
+                          std::pmr::memory_resource* /*scratch*/) {
+    candidate_items.clear();
+    Solution& aux_upper_bound = this->candidate_upper_bound;
     for (int i = 0; i < N; i++) {
       if (this->current_used_items[i]) continue;
-      if (this->items[i].weight > this->current_weight) continue;
-      auto aux_upper_bound = this->current_upper_bound.simulate_add_item(this->current_used_items, i); // Amortized upper bound
+      if (!this->items[i].fits(this->current_weight)) continue;
+      this->current_upper_bound.simulate_add_item(this->current_used_items, i, aux_upper_bound); // Amortized upper bound
       // auto aux_upper_bound = this->greedyUpperBound(this->items[i]); // Greedy upper bound: O(N^2)
       int64_t hv = hv_space.contribution(aux_upper_bound);
       if (hv > 0) {
         candidate_items.push_back({i, hv});
       }
     }
-    std::sort(candidate_items.begin(), candidate_items.end(), [](Candidate a, Candidate b) {
-      return a.second > b.second;
-    });
-    return candidate_items;
   }
 
-  [[nodiscard]] Solution chooseCandidate(const std::vector<Candidate>& selected_candidates) override {
-    int32_t random_item = std::rand() % selected_candidates.size();
+  const Solution& chooseCandidate(const std::vector<Candidate>& selected_candidates) {
+    int32_t random_item = rng::index(selected_candidates.size());
     int32_t selected_item = selected_candidates[random_item].first;
     for (int j = 0; j < M; j++) {
       this->current_solution[j] += this->items[selected_item].values[j];
     }
-    this->current_weight -= this->items[selected_item].weight;
+    for (int d = 0; d < D; d++) {
+      this->current_weight[d] -= this->items[selected_item].weights[d];
+    }
     this->current_used_items[selected_item] = true;
     this->current_upper_bound.update_add_item(this->current_used_items, selected_item);
     return this->current_solution;
   }
 
-  [[nodiscard]] Solution emptySolution() const override {
+  [[nodiscard]] Solution emptySolution() const {
     return Solution(M, 0);
   }
 
-  [[nodiscard]] bool isFeasible(const Solution& solution) const override {
-    return this->current_weight >= 0;
+  [[nodiscard]] DecisionVector emptyDecisions() const {
+    return DecisionVector(N);
+  }
+
+  void getDecisions(DecisionVector& decisions) const {
+    decisions.clear();
+    for (int i = 0; i < N; i++) {
+      if (this->current_used_items[i]) {
+        decisions.set(i);
+      }
+    }
+  }
+
+  [[nodiscard]] bool isFeasible(const Solution& solution) const {
+    return std::all_of(this->current_weight.begin(), this->current_weight.end(), [](const int64_t& remaining) {
+      return remaining >= 0;
+    });
   }
 
-  [[nodiscard]] std::tuple<Solution, std::vector<Solution>> improveSolution(const Solution& current_solution,
-                                                                            const std::vector<Solution>& solution_set) const override {
+  // decisions holds the items of current_solution and is updated with the
+  // items of the improved solution
+  [[nodiscard]] Solution improveSolution(const Solution& current_solution,
+                                         DecisionVector& decisions,
+                                         const std::vector<Solution>& solution_set,
+                                         std::vector<Solution>& other_solutions,
+                                         std::vector<DecisionVector>& other_decisions,
+                                         std::pmr::memory_resource* scratch) const {
     // Implement the logic to improve a solution for MOKP
-    std::vector<int32_t> used_items;
-    std::vector<int32_t> unused_items;
+    // Temporary storage comes from the scratch arena
+    std::pmr::vector<int32_t> used_items(scratch);
+    std::pmr::vector<int32_t> unused_items(scratch);
     used_items.reserve(N);
     unused_items.reserve(N);
-    int64_t weight = 0;
+    // Remaining capacity of each constraint
+    std::pmr::vector<int64_t> remaining(W.begin(), W.end(), scratch);
 
     for (int i = 0; i < N; ++i) {
-      if (current_used_items[i]) {  // Directly check the value
+      if (decisions.test(i)) {
         used_items.push_back(i);
-        weight += items[i].weight;
+        for (int d = 0; d < D; d++) {
+          remaining[d] -= items[i].weights[d];
+        }
       } else {
         unused_items.push_back(i);
       }
     }
 
     // First Improvement Local Search
-    std::vector<Solution> other_solutions;
+    // The archive and the other solutions are kept in SoA form for the dominance checks
+    const DominanceArchive<int64_t> archive(solution_set, M, true, scratch);
+    DominanceArchive<int64_t> others(M, true, scratch);
+    other_decisions.clear();
     Solution best_solution = current_solution;
+    Solution candidate_solution(M, 0);
+    Solution extended_solution(M, 0);
+    std::pmr::vector<int32_t> sorted_unused_items(scratch);
 
     const int32_t n_used = used_items.size();
     const int32_t n_unused = unused_items.size();
     const int32_t n_total = n_used * n_unused;
-    std::vector<int32_t> swap_indices(n_total);
+    std::pmr::vector<int32_t> swap_indices(n_total, scratch);
     std::iota(swap_indices.begin(), swap_indices.end(), 0);
 
     while (true) {
-      std::random_shuffle(used_items.begin(), used_items.end());
-      std::random_shuffle(unused_items.begin(), unused_items.end());
-      std::random_shuffle(swap_indices.begin(), swap_indices.end());
+      std::shuffle(used_items.begin(), used_items.end(), rng::engine());
+      std::shuffle(unused_items.begin(), unused_items.end(), rng::engine());
+      std::shuffle(swap_indices.begin(), swap_indices.end(), rng::engine());
 
       HypervolumeIndicator<int64_t, Solution> hv_space(best_solution, true);
       int64_t best_hv = 0;
@@ -328,39 +486,50 @@ class MOKP : public ProblemBase<Solution, Candidate> {
         int32_t used_item = used_items[idx_used];
         int32_t unused_item = unused_items[idx_unused];
 
-        if (weight - items[used_item].weight + items[unused_item].weight > this->W) {
+        // Items added by the extension step are already in the knapsack
+        if (decisions.test(unused_item)) {
+          continue;
+        }
+        if (!fitsSwap(remaining, items[used_item], items[unused_item])) {
           continue;
         }
 
-        Solution candidate_solution = best_solution;
+        candidate_solution = best_solution;
         for (int j = 0; j < M; j++) {
           candidate_solution[j] -= items[used_item].values[j];
           candidate_solution[j] += items[unused_item].values[j];
         }
 
-        if (is_non_dominated(candidate_solution, solution_set, true) &&
-            is_non_dominated(candidate_solution, other_solutions, true)) {
-          remove_weakly_dominated(other_solutions, candidate_solution, true);
-          other_solutions.push_back(candidate_solution);
+        if (archive.is_non_dominated(candidate_solution) &&
+            others.is_non_dominated(candidate_solution)) {
+          others.remove_weakly_dominated(candidate_solution, other_decisions);
+          others.push_back(candidate_solution);
+          other_decisions.push_back(decisions);
+          other_decisions.back().reset(used_item);
+          other_decisions.back().set(unused_item);
         }
 
         const int64_t hv = hv_space.contribution(candidate_solution);
         if (weakly_dominates(candidate_solution, best_solution, true) || hv > best_hv) {
           best_solution = candidate_solution;
           best_hv = hv;
-          weight = weight - items[used_item].weight + items[unused_item].weight;
+          decisions.reset(used_item);
+          decisions.set(unused_item);
+          for (int d = 0; d < D; d++) {
+            remaining[d] += items[used_item].weights[d] - items[unused_item].weights[d];
+          }
           std::swap(used_items[idx_used], unused_items[idx_unused]);
 
           // Sort the unused items by weight
-          std::vector<int32_t> sorted_unused_items = unused_items;
+          sorted_unused_items = unused_items;
           std::sort(unused_items.begin(), unused_items.end(), [&](const int32_t a, const int32_t b) {
             return items[a].weight < items[b].weight;
           });
           // Try to improve the solution by adding more items
           for (int j = 0; j < n_unused; j++) {
             const int32_t unused_item = sorted_unused_items[j];
-            if (weight + items[unused_item].weight <= this->W) {
-              std::vector<int64_t> extended_solution = best_solution;
+            if (!decisions.test(unused_item) && items[unused_item].fits(remaining)) {
+              extended_solution = best_solution;
               for (int k = 0; k < M; k++) {
                 extended_solution[k] += items[unused_item].values[k];
               }
@@ -368,7 +537,10 @@ class MOKP : public ProblemBase<Solution, Candidate> {
               if (extended_hv > best_hv) {
                 best_solution = extended_solution;
                 best_hv = extended_hv;
-                weight += items[unused_item].weight;
+                decisions.set(unused_item);
+                for (int d = 0; d < D; d++) {
+                  remaining[d] -= items[unused_item].weights[d];
+                }
               }
             }
           }
@@ -380,25 +552,302 @@ class MOKP : public ProblemBase<Solution, Candidate> {
       }
     }
     // Remove weakly dominated solutions
-    remove_weakly_dominated(other_solutions, best_solution, true);
-    // Return the best solution and the other solutions
-    return {best_solution, other_solutions};
+    others.remove_weakly_dominated(best_solution, other_decisions);
+    others.copy_to(other_solutions);
+    // Return the best solution, the other solutions are in other_solutions
+    return best_solution;
+  }
+
+  // Knapsack for the weighted sum sum_j weights[j] * values[j]. With one
+  // constraint it is solved exactly by dynamic programming over the
+  // capacities, O(N * W), ties broken by the sum of the values so that the
+  // solution is nondominated. With several constraints (or tables above
+  // max_dp_bits) it is a greedy fill by weighted value per unit of surrogate
+  // weight, a heuristic; order holds the greedy order of the previous call.
+  [[nodiscard]] Solution solveWeightedSum(const std::vector<int64_t>& weights, DecisionVector& decisions,
+                                          std::vector<int32_t>& order) const {
+    std::vector<int64_t> gain(N, 0);
+    for (int i = 0; i < N; i++) {
+      for (int j = 0; j < M; j++) {
+        gain[i] += weights[j] * items[i].values[j];
+      }
+    }
+    if (D == 1 && dpBits() <= max_dp_bits) {
+      return solveKnapsackDP(gain, decisions);
+    }
+    std::vector<double> ratio(N);
+    for (int i = 0; i < N; i++) {
+      ratio[i] = static_cast<double>(gain[i]) / std::max<int64_t>(items[i].weight, 1);
+    }
+    resort_indices(order, N, [&](const int32_t a, const int32_t b) {
+      if (ratio[a] != ratio[b]) {
+        return ratio[a] > ratio[b];
+      }
+      return items[a].weight != items[b].weight ? items[a].weight < items[b].weight : a < b;
+    });
+    std::vector<int64_t> remaining = W;
+    Solution solution(M, 0);
+    decisions.clear();
+    for (const int32_t& i : order) {
+      if (!items[i].fits(remaining)) continue;
+      for (int d = 0; d < D; d++) {
+        remaining[d] -= items[i].weights[d];
+      }
+      for (int j = 0; j < M; j++) {
+        solution[j] += items[i].values[j];
+      }
+      decisions.set(i);
+    }
+    return solution;
+  }
+
+  // Path relinking: walk from one solution to the other, toggling one of the
+  // items in which they differ at a time. The toggle with the largest
+  // hypervolume contribution (ties broken by the sum of the values) is taken
+  // at every step. Removing an item is always feasible, so the walk reaches
+  // the target.
+  void relinkSolutions(const Solution& from_solution,
+                       const DecisionVector& from_decisions,
+                       const DecisionVector& to_decisions,
+                       const HypervolumeIndicator<int64_t, Solution>& hvc_space,
+                       std::vector<Solution>& relinked_solutions,
+                       std::vector<DecisionVector>& relinked_decisions,
+                       std::pmr::memory_resource* scratch) const {
+    relinked_decisions.clear();
+    std::pmr::vector<int32_t> moves(scratch);
+    DecisionVector::for_each_difference(from_decisions, to_decisions, [&](std::size_t i) {
+      moves.push_back(i);
+    });
+    std::pmr::vector<int64_t> remaining(W.begin(), W.end(), scratch);
+    from_decisions.for_each_set([&](std::size_t i) {
+      for (int d = 0; d < D; d++) {
+        remaining[d] -= items[i].weights[d];
+      }
+    });
+
+    DominanceArchive<int64_t> relinked(M, true, scratch);
+    Solution solution = from_solution;
+    // Working copies are dense, the archived vectors may be sparse
+    DecisionVector decisions = from_decisions;
+    decisions.expand();
+    Solution candidate_solution(M, 0);
+    // The last move reaches the target
+    while (moves.size() > 1) {
+      int32_t best_move = -1;
+      int64_t best_hv = -1;
+      int64_t best_sum = std::numeric_limits<int64_t>::min();
+      for (int32_t k = 0; k < (int32_t)moves.size(); k++) {
+        const Item& item = items[moves[k]];
+        const bool add = !decisions.test(item.idx);
+        if (add && !item.fits(remaining)) continue;
+        int64_t sum = 0;
+        for (int j = 0; j < M; j++) {
+          candidate_solution[j] = solution[j] + (add ? item.values[j] : -item.values[j]);
+          sum += candidate_solution[j];
+        }
+        const int64_t hv = hvc_space.contribution(candidate_solution);
+        if (hv > best_hv || (hv == best_hv && sum > best_sum)) {
+          best_move = k;
+          best_hv = hv;
+          best_sum = sum;
+        }
+      }
+      if (best_move == -1) {
+        break;
+      }
+      const Item& item = items[moves[best_move]];
+      const int64_t sign = decisions.test(item.idx) ? -1 : 1;
+      for (int j = 0; j < M; j++) {
+        solution[j] += sign * item.values[j];
+      }
+      for (int d = 0; d < D; d++) {
+        remaining[d] -= sign * item.weights[d];
+      }
+      decisions.flip(item.idx);
+      moves[best_move] = moves.back();
+      moves.pop_back();
+
+      if (best_hv > 0 && relinked.is_non_dominated(solution)) {
+        relinked.remove_weakly_dominated(solution, relinked_decisions);
+        relinked.push_back(solution);
+        relinked_decisions.push_back(decisions);
+      }
+    }
+    relinked.copy_to(relinked_solutions);
   }
 
  private:
   const int32_t N;                                 // Number of items
   const int32_t M;                                 // Number of objectives
-  const int64_t W;                                 // Maximum Knapsack weight
-  const std::vector<int64_t> weights;              // Weights of the items
+  const int32_t D;                                 // Number of constraints
+  const std::vector<int64_t> W;                    // Maximum Knapsack weight for each constraint
+  const std::vector<int64_t> multipliers;          // Surrogate multipliers of the constraints
+  const std::vector<std::vector<int64_t>> weights;  // Weights of the items
   const std::vector<std::vector<int64_t>> values;  // Values of the items
   const std::vector<Item> items;                   // Items
   const std::vector<Solution> nondominated_set;    // Nondominated set
-  std::vector<std::vector<Item>> sorted_items_objectives;  // Sorted items by objectives
+  std::shared_ptr<const SortedItems> sorted_items_objectives;  // Sorted items by objectives
   Solution reference_point;
   UpperBound current_upper_bound;
   Solution current_solution;
   std::vector<bool> current_used_items;
-  int64_t current_weight;
+  std::vector<int64_t> current_weight;  // Remaining capacity for each constraint
+  // Upper bound of the candidate being scored, a Solution because it is
+  // passed to the hypervolume indicator, so it cannot come from the arena
+  Solution candidate_upper_bound;
+
+  static constexpr double max_dp_bits = 1u << 30;  // Largest tables of solveKnapsackDP (128 MiB)
+
+  // Memory of the tables of solveKnapsackDP, in bits: the decisions (one bit
+  // per item and capacity) and the best keys (at most 128 bits per capacity)
+  [[nodiscard]] double dpBits() const {
+    return (static_cast<double>(N) + 128) * (W[0] + 1);
+  }
+
+  // The tables of all the solveKnapsackDP calls alive at once, on any thread,
+  // stay within max_dp_bits: a call waits until its tables fit in what is
+  // left. Weighted sums run in parallel, one table each would otherwise cost
+  // max_dp_bits per hardware thread.
+  class DPMemory {
+   public:
+    explicit DPMemory(double bits) : bits(bits) {
+      Budget& budget = shared();
+      std::unique_lock<std::mutex> lock(budget.mutex);
+      budget.released.wait(lock, [&] { return budget.used + bits <= max_dp_bits; });
+      budget.used += bits;
+    }
+
+    ~DPMemory() {
+      Budget& budget = shared();
+      {
+        std::lock_guard<std::mutex> lock(budget.mutex);
+        budget.used -= bits;
+      }
+      budget.released.notify_all();
+    }
+
+    DPMemory(const DPMemory&) = delete;
+    DPMemory& operator=(const DPMemory&) = delete;
+
+   private:
+    struct Budget {
+      std::mutex mutex;
+      std::condition_variable released;
+      double used = 0;
+    };
+
+    static Budget& shared() {
+      static Budget budget;
+      return budget;
+    }
+
+    double bits;
+  };
+
+  // 0/1 knapsack with one constraint maximizing gain, then the sum of the
+  // values. Both are packed in one key, gain * (total + 1) + sum, when it
+  // cannot overflow. best[c] is the best key within capacity c after the items
+  // seen so far; above their total weight (reach) it no longer changes, so
+  // only the capacities up to reach are updated. taken holds one bit per item
+  // and capacity to rebuild the solution.
+  Solution solveKnapsackDP(const std::vector<int64_t>& gain, DecisionVector& decisions) const {
+    const DPMemory memory(dpBits());
+    std::vector<int64_t> sums(N, 0);
+    int64_t total = 0, total_gain = 0;
+    for (int i = 0; i < N; i++) {
+      sums[i] = std::accumulate(items[i].values.begin(), items[i].values.end(), int64_t{0});
+      total += sums[i];
+      total_gain += gain[i];
+    }
+    if (total_gain <= (std::numeric_limits<int64_t>::max() - total) / (total + 1)) {
+      std::vector<int64_t> keys(N);
+      for (int i = 0; i < N; i++) {
+        keys[i] = gain[i] * (total + 1) + sums[i];
+      }
+      return solveKnapsackDP(keys, int64_t{0}, decisions);
+    }
+    std::vector<std::pair<int64_t, int64_t>> keys(N);
+    for (int i = 0; i < N; i++) {
+      keys[i] = {gain[i], sums[i]};
+    }
+    return solveKnapsackDP(keys, std::pair<int64_t, int64_t>{0, 0}, decisions);
+  }
+
+  template <typename Key>
+  Solution solveKnapsackDP(const std::vector<Key>& keys, const Key& zero, DecisionVector& decisions) const {
+    const std::size_t capacity = W[0];
+    const std::size_t row = capacity + 1;
+    std::vector<Key> best(row, zero);
+    std::vector<uint64_t> taken((N * row + 63) / 64, 0);
+    std::vector<std::size_t> reach(N);  // Total weight of the items up to i, capped to the capacity
+    for (int i = 0; i < N; i++) {
+      const std::size_t w = items[i].weights[0];
+      const std::size_t previous = i > 0 ? reach[i - 1] : 0;
+      reach[i] = std::min(capacity, previous + w);
+      std::fill(best.begin() + previous + 1, best.begin() + reach[i] + 1, best[previous]);
+      for (std::size_t c = reach[i] + 1; c-- > w;) {
+        const Key with = add(best[c - w], keys[i]);
+        if (best[c] < with) {
+          best[c] = with;
+          const std::size_t bit = i * row + c;
+          taken[bit / 64] |= uint64_t{1} << (bit % 64);
+        }
+      }
+    }
+    Solution solution(M, 0);
+    decisions.clear();
+    std::size_t c = capacity;
+    for (int i = N - 1; i >= 0; i--) {
+      c = std::min(c, reach[i]);
+      const std::size_t bit = i * row + c;
+      if (!(taken[bit / 64] >> (bit % 64) & 1)) continue;
+      for (int j = 0; j < M; j++) {
+        solution[j] += items[i].values[j];
+      }
+      decisions.set(i);
+      c -= items[i].weights[0];
+    }
+    return solution;
+  }
+
+  static int64_t add(const int64_t& a, const int64_t& b) {
+    return a + b;
+  }
+
+  static std::pair<int64_t, int64_t> add(const std::pair<int64_t, int64_t>& a, const std::pair<int64_t, int64_t>& b) {
+    return {a.first + b.first, a.second + b.second};
+  }
+
+  // Integer multipliers that bring every constraint to the scale of the largest
+  // capacity. Any non-negative multipliers give a valid surrogate relaxation.
+  static std::vector<int64_t> surrogateMultipliers(const std::vector<int64_t>& W) {
+    const int64_t max_W = *std::max_element(W.begin(), W.end());
+    std::vector<int64_t> multipliers(W.size(), 1);
+    for (int d = 0; d < (int)W.size(); d++) {
+      if (W[d] > 0) {
+        multipliers[d] = std::max<int64_t>(1, (max_W + W[d] / 2) / W[d]);
+      }
+    }
+    return multipliers;
+  }
+
+  static int64_t surrogate(const std::vector<int64_t>& weights, const std::vector<int64_t>& multipliers) {
+    int64_t surrogate_weight = 0;
+    for (int d = 0; d < (int)weights.size(); d++) {
+      surrogate_weight += multipliers[d] * weights[d];
+    }
+    return surrogate_weight;
+  }
+
+  // True if replacing used_item by unused_item keeps every constraint satisfied
+  bool fitsSwap(const std::pmr::vector<int64_t>& remaining, const Item& used_item, const Item& unused_item) const {
+    for (int d = 0; d < D; d++) {
+      if (unused_item.weights[d] - used_item.weights[d] > remaining[d]) {
+        return false;
+      }
+    }
+    return true;
+  }
 
   [[nodiscard]] Solution greedyUpperBound(const Item & try_item) const {
     std::vector<int64_t> upper_bound = this->current_solution;
@@ -407,9 +856,9 @@ class MOKP : public ProblemBase<Solution, Candidate> {
       upper_bound[i] += try_item.values[i];
     }
     for (int i = 0; i < this->M; i++) {
-      int64_t remaining_weight = this->current_weight - try_item.weight;
+      int64_t remaining_weight = surrogate(this->current_weight, this->multipliers) - try_item.weight;
       for (int j = 0; j < this->N; j++) {
-        const Item& item = this->sorted_items_objectives[i][j];
+        const Item& item = (*this->sorted_items_objectives)[i][j];
         if (current_used_items[item.idx] || try_item.idx == item.idx) continue;
         if (remaining_weight - item.weight >= 0) {
           upper_bound[i] += item.values[i];
@@ -441,18 +890,19 @@ class MOKP : public ProblemBase<Solution, Candidate> {
     return upper_bound;
   }
 
-  [[nodiscard]] std::vector<std::vector<Item>> sortItemsObjectives(const std::vector<Item>& items) {
-    std::vector<std::vector<Item>> sorted_items(this->M);
-    for (int i = 0; i < M; i++) {
-      sorted_items[i] = items;
-      std::sort(sorted_items[i].begin(), sorted_items[i].end(),
+  // The objectives are sorted in parallel
+  [[nodiscard]] static std::shared_ptr<const SortedItems> sortItemsObjectives(const std::vector<Item>& items, const int32_t& M) {
+    auto sorted_items = std::make_shared<SortedItems>(M);
+    parallel_for(M, [&](std::size_t i) {
+      (*sorted_items)[i] = items;
+      std::sort((*sorted_items)[i].begin(), (*sorted_items)[i].end(),
                 [i](const Item& a, const Item& b) {
                   double ra = static_cast<double>(a.values[i]) / a.weight;
                   double rb = static_cast<double>(b.values[i]) / b.weight;
                   if (ra != rb) return ra > rb;
                   return a.weight < b.weight;
                 });
-    }
+    });
     return sorted_items;
   }
 };
@@ -1,18 +1,38 @@
 #ifndef MOMST_HPP
 #define MOMST_HPP
 
+#include <dominance.hpp>
+#include <dominance_archive.hpp>
+#include <limits>
+#include <memory_resource>
+#include <numeric>
+#include <parallel.hpp>
 #include <problem_base.hpp>
+#include <random.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 
 typedef std::pair<int64_t, int32_t> pii;
 
+// Disjoint sets with union by rank and without path compression, so find()
+// does not write and a union-find can be read by several threads at once.
+// Unions are logged: rollback(checkpoint()) undoes the unions made since the
+// checkpoint in O(unions), instead of copying or rebuilding the O(V) arrays.
 class UnionFind {
  public:
   UnionFind() = default;
 
-  UnionFind(int32_t size) : parent(size), rank(size, 0) {
-    for (int32_t i = 0; i < size; ++i) {
-      parent[i] = i;
-    }
+  UnionFind(int32_t size, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : parent(size, resource), rank(size, 0, resource), history(resource) {
+    reset();
+  }
+
+  // Make every element its own set again, reusing the existing storage
+  void reset() {
+    std::iota(parent.begin(), parent.end(), 0);
+    std::fill(rank.begin(), rank.end(), 0);
+    history.clear();
   }
 
   bool unite(int32_t u, int32_t v) {
@@ -24,6 +44,7 @@ class UnionFind {
     if (rank[u] < rank[v]) {
       std::swap(u, v);
     }
+    history.push_back({v, rank[u] == rank[v]});
     if (rank[u] == rank[v]) {
       rank[u]++;
     }
@@ -35,16 +56,50 @@ class UnionFind {
     return find(u) != find(v);
   }
 
- private:
+  // Representative of the set of u, O(log V) by the union by rank
   int32_t find(int32_t u) const {
-    if (parent[u] != u) {
-      parent[u] = find(parent[u]);
+    while (parent[u] != u) {
+      u = parent[u];
+    }
+    return u;
+  }
+
+  // State to roll back to
+  [[nodiscard]] std::size_t checkpoint() const {
+    return history.size();
+  }
+
+  // Undo the unions made since checkpoint, latest first
+  void rollback(std::size_t checkpoint) {
+    while (history.size() > checkpoint) {
+      const Union last = history.back();
+      history.pop_back();
+      if (last.rank_increased) {
+        rank[parent[last.child]]--;
+      }
+      parent[last.child] = last.child;
     }
-    return parent[u];
   }
 
-  mutable std::vector<int32_t> parent;
-  mutable std::vector<int32_t> rank;
+  // Point every element directly to its representative, for a union-find
+  // that is read much more often than it changes. Clears the history, the
+  // flattened unions cannot be rolled back.
+  void flatten() {
+    for (std::size_t u = 0; u < parent.size(); ++u) {
+      parent[u] = find(u);
+    }
+    history.clear();
+  }
+
+ private:
+  struct Union {
+    int32_t child;        // Former representative, now below the other one
+    bool rank_increased;  // The rank of the new representative was increased
+  };
+
+  std::pmr::vector<int32_t> parent;
+  std::pmr::vector<int32_t> rank;
+  std::pmr::vector<Union> history;
 };
 
 struct Edge {
@@ -70,7 +125,7 @@ struct Node {
 };
 
 template <typename Solution, typename Candidate>
-class MOMST : public ProblemBase<Solution, Candidate> {
+class MOMST : public ProblemBase<MOMST<Solution, Candidate>, Solution, Candidate> {
   MOMST(int32_t V, int32_t E, int32_t M,
         std::vector<Node> nodes,
         std::vector<Edge> edges,
@@ -86,10 +141,11 @@ class MOMST : public ProblemBase<Solution, Candidate> {
         current_solution(M, 0),
         current_n_edges(0),
         current_used_edges(E, false),
-        current_union_find(V) {
-    // Sort the edges by increasing values (lexicographically)
+        current_union_find(V),
+        bound_buffers(V, E, M) {
+    // Sort the edges by increasing values (lexicographically), one objective per thread
     std::vector<std::vector<Edge>> sorted_edges(M);
-    for (int i = 0; i < M; i++) {
+    parallel_for(M, [&](std::size_t i) {
       sorted_edges[i] = edges;
       std::sort(sorted_edges[i].begin(), sorted_edges[i].end(), [i, M](const Edge& a, const Edge& b) {
         for (int j = 0; j < M; j++) {
@@ -100,19 +156,43 @@ class MOMST : public ProblemBase<Solution, Candidate> {
         }
         return false;  // All values are equal
       });
-    }
-    this->sorted_edges = sorted_edges;
+    });
+    this->sorted_edges = std::move(sorted_edges);
     // Compute the reference point
-    this->reference_point = compute_reference_point(M);
+    this->reference_point = compute_reference_point();
   }
 
  public:
   template <typename IStream>
   static auto from_stream(IStream&& is) -> MOMST {
+    // The header is "V" for a bi-objective complete graph, "V E" for a
+    // bi-objective graph with E edges or "V E M"
     int32_t V, M = 2, E;
-    is >> V;
-    // is >> E; // TODO: Uncomment this line if the number of edges is given in the input
+    std::string header;
+    while (header.find_first_not_of(" \t\r") == std::string::npos && std::getline(is, header)) {
+    }
+    std::istringstream header_stream(header);
+    if (!(header_stream >> V) || V < 1) {
+      throw std::invalid_argument("Invalid MOMST header: V must be a positive integer");
+    }
     E = (V * (V - 1)) / 2;
+    int32_t header_E, header_M;
+    if (header_stream >> header_E) {
+      E = header_E;
+      if (header_stream >> header_M) {
+        M = header_M;
+      } else if (!header_stream.eof()) {
+        throw std::invalid_argument("Invalid MOMST header: M must be a positive integer");
+      }
+    } else if (!header_stream.eof()) {
+      throw std::invalid_argument("Invalid MOMST header: E must be a positive integer");
+    }
+    if (E < 1) {
+      throw std::invalid_argument("Invalid MOMST header: E must be at least 1, got " + std::to_string(E));
+    }
+    if (M < 1) {
+      throw std::invalid_argument("Invalid MOMST header: M must be at least 1, got " + std::to_string(M));
+    }
     std::vector<Node> nodes(V);
     std::vector<Edge> edges(E);
     for (int i = 0; i < E; i++) {
@@ -122,6 +202,13 @@ class MOMST : public ProblemBase<Solution, Candidate> {
       for (int j = 0; j < M; j++) {
         is >> values[j];
       }
+      if (is.fail()) {
+        throw std::invalid_argument("Invalid MOMST instance: expected " + std::to_string(E) + " edges, read " + std::to_string(i));
+      }
+      if (src < 0 || src >= V || dst < 0 || dst >= V) {
+        throw std::invalid_argument("Invalid MOMST instance: edge " + std::to_string(i) + " has an endpoint outside [0, " +
+                                    std::to_string(V) + ")");
+      }
       edges[i] = Edge(i, src, dst, values);
     }
 
@@ -133,7 +220,7 @@ class MOMST : public ProblemBase<Solution, Candidate> {
     std::vector<Solution> supported_set;
     std::vector<Solution> nondominated_set;
     if (!is.eof()) {
-      int32_t n_supported_set;
+      int32_t n_supported_set = 0;
       is >> n_supported_set;
       supported_set = std::vector<Solution>(n_supported_set, Solution(M, 0));
       for (int i = 0; i < n_supported_set; i++) {
@@ -141,7 +228,7 @@ class MOMST : public ProblemBase<Solution, Candidate> {
           is >> supported_set[i][j];
         }
       }
-      int32_t n_nondominated_set;
+      int32_t n_nondominated_set = 0;  // Stays 0 if the stream ended before it
       is >> n_nondominated_set;
       nondominated_set = std::vector<Solution>(n_nondominated_set, Solution(M, 0));
       for (int i = 0; i < n_nondominated_set; i++) {
@@ -153,46 +240,46 @@ class MOMST : public ProblemBase<Solution, Candidate> {
     return MOMST(V, E, M, nodes, edges, nondominated_set, supported_set);
   }
 
-  void reset() override {
-    this->current_solution = Solution(this->M, 0);
+  void reset() {
+    // Reuse the existing storage, a reset must not allocate
+    std::fill(this->current_solution.begin(), this->current_solution.end(), 0);
     this->current_n_edges = 0;
-    this->current_used_edges = std::vector<bool>(this->E, false);
-    this->current_union_find = UnionFind(this->V);
+    std::fill(this->current_used_edges.begin(), this->current_used_edges.end(), false);
+    this->current_union_find.reset();
   }
 
-  [[nodiscard]] std::vector<Solution> getNondominatedSet() const override {
+  [[nodiscard]] const std::vector<Solution>& getNondominatedSet() const {
     return this->nondominated_set;
   }
 
-  [[nodiscard]] std::vector<int64_t> getReferencePoint() const override {
+  [[nodiscard]] const Solution& getReferencePoint() const {
     return this->reference_point;
   }
 
-  [[nodiscard]] std::vector<Candidate> generateCandidates(const Solution& current_solution,
-                                                          const std::vector<Solution>& solution_set,
-                                                          const HypervolumeIndicator<int64_t, Solution>& hvc_space) const override {
-    std::vector<Candidate> candidate_edges;
+  void generateCandidates(const Solution& current_solution,
+                          const std::vector<Solution>& solution_set,
+                          const HypervolumeIndicator<int64_t, Solution>& hvc_space,
+                          std::vector<Candidate>& candidate_edges,
+                          std::pmr::memory_resource* /*scratch*/) {
+    candidate_edges.clear();
+    std::vector<int64_t>& lower_bounds = this->bound_buffers.lower_bounds;
+    compute_bound_forests(this->current_union_find, this->current_used_edges, this->current_n_edges + 1, this->bound_buffers);
+    Solution& candidate_lower_bound = this->bound_buffers.candidate_lower_bound;
     for (int i = 0; i < E; i++) {
       if (this->current_used_edges[i]) continue;
       if (!this->current_union_find.can_unite(this->edges[i].src, this->edges[i].dst)) continue;
-      Solution aux_lower_bound = compute_bound_kruskal(this->current_union_find, this->current_used_edges, this->current_n_edges + 1, i);
-      Solution candidate_lower_bound = Solution(M, 0);
       for (int j = 0; j < M; j++) {
-        candidate_lower_bound[j] = this->current_solution[j] + this->edges[i].values[j] + aux_lower_bound[j];
+        candidate_lower_bound[j] = this->current_solution[j] + this->edges[i].values[j] + lower_bounds[i * M + j];
       }
       int64_t hv = hvc_space.contribution(candidate_lower_bound);
       if (hv > 0) {
         candidate_edges.push_back({i, hv});
       }
     }
-    std::sort(candidate_edges.begin(), candidate_edges.end(), [](Candidate a, Candidate b) {
-      return a.second > b.second;
-    });
-    return candidate_edges;
   }
 
-  [[nodiscard]] Solution chooseCandidate(const std::vector<Candidate>& selected_candidates) override {
-    int32_t random_edge = std::rand() % selected_candidates.size();
+  const Solution& chooseCandidate(const std::vector<Candidate>& selected_candidates) {
+    int32_t random_edge = rng::index(selected_candidates.size());
     int32_t selected_edge = selected_candidates[random_edge].first;
     for (int j = 0; j < M; j++) {
       this->current_solution[j] += this->edges[selected_edge].values[j];
@@ -202,27 +289,50 @@ class MOMST : public ProblemBase<Solution, Candidate> {
       std::cerr << "Error: The selected edge cannot be added to the current solution\n";
       throw std::runtime_error("Invalid union operation");
     }
+    // Read O(E) times per candidate list, changed once per step
+    this->current_union_find.flatten();
     this->current_n_edges += 1;
     return this->current_solution;
   }
 
-  [[nodiscard]] Solution emptySolution() const override {
+  [[nodiscard]] Solution emptySolution() const {
     return Solution(this->M, 0);
   }
 
-  [[nodiscard]] bool isFeasible(const Solution& solution) const override {
+  [[nodiscard]] DecisionVector emptyDecisions() const {
+    return DecisionVector(this->E);
+  }
+
+  void getDecisions(DecisionVector& decisions) const {
+    decisions.clear();
+    for (int i = 0; i < this->E; i++) {
+      if (this->current_used_edges[i]) {
+        decisions.set(i);
+      }
+    }
+  }
+
+  [[nodiscard]] bool isFeasible(const Solution& solution) const {
     return current_n_edges == this->V - 1;
   }
 
-  [[nodiscard]] std::tuple<Solution, std::vector<Solution>> improveSolution(const Solution& current_solution, const std::vector<Solution>& solution_set) const override {
+  // decisions holds the edges of current_solution and is updated with the
+  // edges of the improved solution
+  [[nodiscard]] Solution improveSolution(const Solution& current_solution,
+                                         DecisionVector& decisions,
+                                         const std::vector<Solution>& solution_set,
+                                         std::vector<Solution>& other_solutions,
+                                         std::vector<DecisionVector>& other_decisions,
+                                         std::pmr::memory_resource* scratch) const {
     // Implement the logic to improve a solution for MOMST
-    std::vector<int32_t> used_edges;
-    std::vector<int32_t> unused_edges;
+    // Temporary storage comes from the scratch arena
+    std::pmr::vector<int32_t> used_edges(scratch);
+    std::pmr::vector<int32_t> unused_edges(scratch);
     used_edges.reserve(this->E);
     unused_edges.reserve(this->E);
 
     for (int i = 0; i < this->E; ++i) {
-      if (this->current_used_edges[i]) {  // Directly check the value
+      if (decisions.test(i)) {
         used_edges.push_back(i);
       } else {
         unused_edges.push_back(i);
@@ -230,20 +340,69 @@ class MOMST : public ProblemBase<Solution, Candidate> {
     }
 
     // First Improvement Local Search
-    std::vector<Solution> other_solutions;
+    // The archive and the other solutions are kept in SoA form for the dominance checks
+    const DominanceArchive<int64_t> archive(solution_set, M, false, scratch);
+    DominanceArchive<int64_t> others(M, false, scratch);
+    other_decisions.clear();
     Solution best_solution = current_solution;
-    UnionFind best_union_find = this->current_union_find;
+    Solution candidate_solution(M, 0);
+
+    // The tree rooted at vertex 0, numbered in depth-first order. Removing the
+    // used edge above vertex c leaves the vertices u with
+    // enter[c] <= enter[u] < leave[c] on one side and the rest on the other,
+    // so an exchange is checked in O(1) instead of rebuilding a union-find.
+    std::pmr::vector<int32_t> head(V, -1, scratch);
+    std::pmr::vector<int32_t> next(2 * (V - 1), -1, scratch);
+    std::pmr::vector<int32_t> cursor(V, -1, scratch);
+    std::pmr::vector<int32_t> parent(V, -1, scratch);
+    std::pmr::vector<int32_t> enter(V, 0, scratch);
+    std::pmr::vector<int32_t> leave(V, 0, scratch);
+    std::pmr::vector<int32_t> stack(scratch);
+    stack.reserve(V);
+    auto number_tree = [&]() {
+      std::fill(head.begin(), head.end(), -1);
+      for (int32_t k = 0; k < (int32_t)used_edges.size(); ++k) {
+        const Edge& edge = this->edges[used_edges[k]];
+        next[2 * k] = head[edge.src];
+        head[edge.src] = 2 * k;
+        next[2 * k + 1] = head[edge.dst];
+        head[edge.dst] = 2 * k + 1;
+      }
+      cursor = head;
+      std::fill(parent.begin(), parent.end(), -1);
+      int32_t clock = 0;
+      parent[0] = 0;
+      enter[0] = clock++;
+      stack.assign(1, 0);
+      while (!stack.empty()) {
+        const int32_t u = stack.back();
+        const int32_t a = cursor[u];
+        if (a == -1) {
+          leave[u] = clock;
+          stack.pop_back();
+          continue;
+        }
+        cursor[u] = next[a];
+        const Edge& edge = this->edges[used_edges[a / 2]];
+        const int32_t v = a % 2 == 0 ? edge.dst : edge.src;
+        if (parent[v] != -1) continue;
+        parent[v] = u;
+        enter[v] = clock++;
+        stack.push_back(v);
+      }
+    };
 
     const int32_t n_used = used_edges.size();
     const int32_t n_unused = unused_edges.size();
     const int32_t n_total = n_used * n_unused;
-    std::vector<int32_t> swap_indices(n_total);
+    std::pmr::vector<int32_t> swap_indices(n_total, scratch);
     std::iota(swap_indices.begin(), swap_indices.end(), 0);
 
     while (true) {
-      std::random_shuffle(used_edges.begin(), used_edges.end());
-      std::random_shuffle(unused_edges.begin(), unused_edges.end());
-      std::random_shuffle(swap_indices.begin(), swap_indices.end());
+      number_tree();
+      std::shuffle(used_edges.begin(), used_edges.end(), rng::engine());
+      std::shuffle(unused_edges.begin(), unused_edges.end(), rng::engine());
+      std::shuffle(swap_indices.begin(), swap_indices.end(), rng::engine());
 
       HypervolumeIndicator<int64_t, Solution> hv_space(best_solution, false);
       int64_t best_hv = 0;
@@ -254,38 +413,39 @@ class MOMST : public ProblemBase<Solution, Candidate> {
         int32_t used_edge = used_edges[idx_used];
         int32_t unused_edge = unused_edges[idx_unused];
 
-        // Check if the edge can be added to the current solution
-        UnionFind uf_aux(V);
-        bool valid = true;
-        for (size_t j = 0; j < used_edges.size(); ++j) {
-          if (j == static_cast<size_t>(idx_used)) continue;
-          const Edge& edge = this->edges[used_edges[j]];
-          if (!uf_aux.unite(edge.src, edge.dst)) {
-            valid = false;
-            break;
-          }
-        }
-        if (!uf_aux.unite(edges[unused_edge].src, edges[unused_edge].dst)) {
+        // The exchange keeps a tree iff the added edge reconnects the two
+        // sides of the removed one
+        const Edge& removed = this->edges[used_edge];
+        const int32_t below = parent[removed.dst] == removed.src ? removed.dst : removed.src;
+        auto is_below = [&](int32_t u) {
+          return enter[below] <= enter[u] && enter[u] < leave[below];
+        };
+        if (is_below(this->edges[unused_edge].src) == is_below(this->edges[unused_edge].dst)) {
           continue;
         }
 
         // Compute the candidate solution
-        Solution candidate_solution = best_solution;
+        candidate_solution = best_solution;
         for (int j = 0; j < M; j++) {
           candidate_solution[j] -= this->edges[used_edge].values[j];
           candidate_solution[j] += this->edges[unused_edge].values[j];
         }
 
-        if (is_non_dominated(candidate_solution, solution_set, false) &&
-            is_non_dominated(candidate_solution, other_solutions, false)) {
-          remove_weakly_dominated(other_solutions, candidate_solution, false);
-          other_solutions.push_back(candidate_solution);
+        if (archive.is_non_dominated(candidate_solution) &&
+            others.is_non_dominated(candidate_solution)) {
+          others.remove_weakly_dominated(candidate_solution, other_decisions);
+          others.push_back(candidate_solution);
+          other_decisions.push_back(decisions);
+          other_decisions.back().reset(used_edge);
+          other_decisions.back().set(unused_edge);
         }
 
         const int64_t hv = hv_space.contribution(candidate_solution);
         if (weakly_dominates(candidate_solution, best_solution, false) || hv > best_hv) {
           best_solution = candidate_solution;
           best_hv = hv;
+          decisions.reset(used_edge);
+          decisions.set(unused_edge);
           std::swap(used_edges[idx_used], unused_edges[idx_unused]);
           break;
         }
@@ -295,9 +455,167 @@ class MOMST : public ProblemBase<Solution, Candidate> {
       }
     }
     // Remove weakly dominated solutions
-    remove_weakly_dominated(other_solutions, best_solution, false);
-    // Return the best solution and the other solutions
-    return {best_solution, other_solutions};
+    others.remove_weakly_dominated(best_solution, other_decisions);
+    others.copy_to(other_solutions);
+    // Return the best solution, the other solutions are in other_solutions
+    return best_solution;
+  }
+
+  // Minimum spanning tree for the cost sum_j weights[j] * values[j] (Kruskal).
+  // Ties are broken by the values in lexicographic order, so a weight of 0
+  // still gives a nondominated tree. order holds the edges sorted for the
+  // previous weights.
+  [[nodiscard]] Solution solveWeightedSum(const std::vector<int64_t>& weights, DecisionVector& decisions,
+                                          std::vector<int32_t>& order) const {
+    std::vector<int64_t> cost(this->E, 0);
+    for (int i = 0; i < this->E; ++i) {
+      for (int j = 0; j < M; ++j) {
+        cost[i] += weights[j] * this->edges[i].values[j];
+      }
+    }
+    resort_indices(order, this->E, [&](const int32_t a, const int32_t b) {
+      if (cost[a] != cost[b]) {
+        return cost[a] < cost[b];
+      }
+      if (this->edges[a].values != this->edges[b].values) {
+        return this->edges[a].values < this->edges[b].values;
+      }
+      return a < b;
+    });
+    UnionFind uf(this->V);
+    Solution solution(M, 0);
+    decisions.clear();
+    int32_t missing = this->V - 1;
+    for (std::size_t k = 0; k < order.size() && missing > 0; ++k) {
+      const Edge& edge = this->edges[order[k]];
+      if (!uf.unite(edge.src, edge.dst)) continue;
+      for (int j = 0; j < M; ++j) {
+        solution[j] += edge.values[j];
+      }
+      decisions.set(edge.idx);
+      --missing;
+    }
+    return solution;
+  }
+
+  // Path relinking: walk from one tree to the other with edge exchanges. At
+  // every step an edge of the target tree is added and an edge of the cycle
+  // it closes, not in the target tree, is removed. Such an edge always exists,
+  // so every exchange keeps a spanning tree. The exchange with the largest
+  // hypervolume contribution (ties broken by the sum of the values) is taken.
+  void relinkSolutions(const Solution& from_solution,
+                       const DecisionVector& from_decisions,
+                       const DecisionVector& to_decisions,
+                       const HypervolumeIndicator<int64_t, Solution>& hvc_space,
+                       std::vector<Solution>& relinked_solutions,
+                       std::vector<DecisionVector>& relinked_decisions,
+                       std::pmr::memory_resource* scratch) const {
+    relinked_decisions.clear();
+    std::pmr::vector<int32_t> to_add(scratch);  // Edges of the target tree not in the current one
+    DecisionVector::for_each_difference(from_decisions, to_decisions, [&](std::size_t i) {
+      if (to_decisions.test(i)) {
+        to_add.push_back(i);
+      }
+    });
+
+    DominanceArchive<int64_t> relinked(M, false, scratch);
+    Solution solution = from_solution;
+    // Working copies are dense, the archived vectors may be sparse
+    DecisionVector decisions = from_decisions;
+    decisions.expand();
+    DecisionVector target = to_decisions;
+    target.expand();
+    Solution candidate_solution(M, 0);
+    std::pmr::vector<int32_t> head(this->V, -1, scratch);
+    std::pmr::vector<int32_t> next(2 * (this->V - 1), -1, scratch);
+    std::pmr::vector<int32_t> tree_edges(scratch);
+    std::pmr::vector<int32_t> parent(this->V, -1, scratch);
+    std::pmr::vector<int32_t> parent_edge(this->V, -1, scratch);
+    std::pmr::vector<int32_t> depth(this->V, 0, scratch);
+    std::pmr::vector<int32_t> queue(scratch);
+    tree_edges.reserve(this->V - 1);
+    queue.reserve(this->V);
+
+    // The last exchange reaches the target tree
+    while (to_add.size() > 1) {
+      // Root the current tree at vertex 0
+      tree_edges.clear();
+      decisions.for_each_set([&](std::size_t i) {
+        tree_edges.push_back(i);
+      });
+      std::fill(head.begin(), head.end(), -1);
+      for (int32_t k = 0; k < (int32_t)tree_edges.size(); ++k) {
+        const Edge& edge = edges[tree_edges[k]];
+        next[2 * k] = head[edge.src];
+        head[edge.src] = 2 * k;
+        next[2 * k + 1] = head[edge.dst];
+        head[edge.dst] = 2 * k + 1;
+      }
+      std::fill(parent.begin(), parent.end(), -1);
+      parent[0] = 0;
+      depth[0] = 0;
+      queue.clear();
+      queue.push_back(0);
+      for (std::size_t q = 0; q < queue.size(); ++q) {
+        const int32_t u = queue[q];
+        for (int32_t a = head[u]; a != -1; a = next[a]) {
+          const Edge& edge = edges[tree_edges[a / 2]];
+          const int32_t v = a % 2 == 0 ? edge.dst : edge.src;
+          if (parent[v] != -1) continue;
+          parent[v] = u;
+          parent_edge[v] = edge.idx;
+          depth[v] = depth[u] + 1;
+          queue.push_back(v);
+        }
+      }
+
+      // Evaluate the exchanges of every edge to add with the edges of its cycle
+      int32_t best_add = -1, best_remove = -1;
+      int64_t best_hv = -1;
+      int64_t best_sum = std::numeric_limits<int64_t>::max();
+      for (int32_t k = 0; k < (int32_t)to_add.size(); ++k) {
+        const Edge& add = edges[to_add[k]];
+        int32_t u = add.src, v = add.dst;
+        while (u != v) {
+          if (depth[u] < depth[v]) {
+            std::swap(u, v);
+          }
+          const int32_t remove = parent_edge[u];
+          u = parent[u];
+          if (target.test(remove)) continue;
+          int64_t sum = 0;
+          for (int j = 0; j < M; j++) {
+            candidate_solution[j] = solution[j] + add.values[j] - edges[remove].values[j];
+            sum += candidate_solution[j];
+          }
+          const int64_t hv = hvc_space.contribution(candidate_solution);
+          if (hv > best_hv || (hv == best_hv && sum < best_sum)) {
+            best_add = k;
+            best_remove = remove;
+            best_hv = hv;
+            best_sum = sum;
+          }
+        }
+      }
+      if (best_add == -1) {
+        break;
+      }
+      const Edge& add = edges[to_add[best_add]];
+      for (int j = 0; j < M; j++) {
+        solution[j] += add.values[j] - edges[best_remove].values[j];
+      }
+      decisions.set(add.idx);
+      decisions.reset(best_remove);
+      to_add[best_add] = to_add.back();
+      to_add.pop_back();
+
+      if (best_hv > 0 && relinked.is_non_dominated(solution)) {
+        relinked.remove_weakly_dominated(solution, relinked_decisions);
+        relinked.push_back(solution);
+        relinked_decisions.push_back(decisions);
+      }
+    }
+    relinked.copy_to(relinked_solutions);
   }
 
  private:
@@ -315,25 +633,200 @@ class MOMST : public ProblemBase<Solution, Candidate> {
   std::vector<bool> current_used_edges;
   UnionFind current_union_find;
 
-  Solution compute_bound_kruskal(const UnionFind& current_union_find,
-                                 const std::vector<bool>& current_used_edges,
-                                 const int32_t& current_n_edges,
-                                 const int32_t& used_edge) const {
-    std::vector<int64_t> lower_bound(M, 0);
-    for (int i = 0; i < M; ++i) {
-      UnionFind uf_aux = current_union_find;
-      int32_t count = this->V - 1 - current_n_edges;
-      const auto& edges = sorted_edges[i];
-      for (const auto& edge : edges) {
-        if (current_used_edges[edge.idx] || edge.idx == used_edge) continue;
-        if (!uf_aux.can_unite(edge.src, edge.dst)) continue;
-        lower_bound[i] += edge.values[i];
-        --count;
-        uf_aux.unite(edge.src, edge.dst);
-        if (count == 0) break;
+  // Buffers of compute_bound_forests, sized once: a construction step takes
+  // O(E) of them, too much for the scratch arena, which is only reset once
+  // per iteration. Like the rest of the construction state, they belong to
+  // this copy of the problem (each parallel worker has its own).
+  struct BoundBuffers {
+    BoundBuffers(int32_t V, int32_t E, int32_t M)
+        : lower_bounds(static_cast<std::size_t>(E) * M, 0),
+          candidate_lower_bound(M, 0),
+          uf_aux(V),
+          forest_position(E, -1),
+          replacement(E, -1),
+          head(V, -1),
+          parent(V, -1),
+          parent_edge(V, -1),
+          depth(V, 0),
+          tree(V, -1),
+          jump(V, 0) {
+      forest.reserve(V);
+      non_forest.reserve(E);
+      next.reserve(2 * V);
+      queue.reserve(V);
+    }
+
+    std::vector<int64_t> lower_bounds;  // lower_bounds[edge * M + objective]
+    Solution candidate_lower_bound;     // Bound of the candidate being scored
+    UnionFind uf_aux;
+    std::vector<int32_t> forest;           // Forest edges in sorted order
+    std::vector<int32_t> non_forest;       // Edges between components left out of the forest
+    std::vector<int32_t> forest_position;
+    std::vector<int32_t> replacement;
+    std::vector<int32_t> head;  // Adjacency of the forest on the components
+    std::vector<int32_t> next;
+    std::vector<int32_t> parent;
+    std::vector<int32_t> parent_edge;
+    std::vector<int32_t> depth;
+    std::vector<int32_t> tree;
+    std::vector<int32_t> jump;
+    std::vector<int32_t> queue;
+  };
+  BoundBuffers bound_buffers;
+
+  // Lower bound on the cost of completing the tree once each candidate edge is
+  // added, written to buffers.lower_bounds[edge * M + objective]. For every objective
+  // it is the cost of the first (V - 1 - n_edges) edges that Kruskal picks on
+  // the contracted graph without the candidate edge.
+  //
+  // Instead of running Kruskal per candidate, the base forest F of each
+  // objective is built once. Without a candidate e, Kruskal returns F when
+  // e is not in F, and F - e + r(e) otherwise, where the replacement r(e) is
+  // the first non-forest edge (in sorted order) whose forest path covers e.
+  // The replacements of all forest edges are found with one pass over the
+  // non-forest edges, jumping over already covered forest edges.
+  void compute_bound_forests(const UnionFind& current_union_find,
+                             const std::vector<bool>& current_used_edges,
+                             const int32_t& n_edges,
+                             BoundBuffers& buffers) const {
+    std::vector<int64_t>& lower_bounds = buffers.lower_bounds;
+    std::fill(lower_bounds.begin(), lower_bounds.end(), 0);
+    const int32_t needed = this->V - 1 - n_edges;  // Edges still needed after the candidate
+    if (needed <= 0) {
+      return;  // The candidate completes the tree
+    }
+    UnionFind& uf_aux = buffers.uf_aux;
+    std::vector<int32_t>& forest = buffers.forest;
+    std::vector<int32_t>& non_forest = buffers.non_forest;
+    std::vector<int32_t>& forest_position = buffers.forest_position;
+    std::vector<int32_t>& replacement = buffers.replacement;
+    std::vector<int32_t>& head = buffers.head;
+    std::vector<int32_t>& next = buffers.next;
+    std::vector<int32_t>& parent = buffers.parent;
+    std::vector<int32_t>& parent_edge = buffers.parent_edge;
+    std::vector<int32_t>& depth = buffers.depth;
+    std::vector<int32_t>& tree = buffers.tree;
+    std::vector<int32_t>& jump = buffers.jump;
+    std::vector<int32_t>& queue = buffers.queue;
+
+    // Lowest vertex of the jump chain whose parent edge is not covered yet
+    auto find_jump = [&](int32_t u) {
+      while (jump[u] != u) {
+        jump[u] = jump[jump[u]];
+        u = jump[u];
+      }
+      return u;
+    };
+
+    // The unions of each objective are rolled back instead of copying the union-find again
+    uf_aux = current_union_find;
+    const std::size_t contracted = uf_aux.checkpoint();
+    for (int j = 0; j < M; ++j) {
+      // Base forest of objective j
+      uf_aux.rollback(contracted);
+      forest.clear();
+      non_forest.clear();
+      std::fill(forest_position.begin(), forest_position.end(), -1);
+      std::fill(replacement.begin(), replacement.end(), -1);
+      int64_t forest_cost = 0;
+      for (const auto& edge : sorted_edges[j]) {
+        if (current_used_edges[edge.idx]) continue;
+        // Edges inside a component are rejected by the flat union-find
+        if (!current_union_find.can_unite(edge.src, edge.dst)) continue;
+        if (uf_aux.unite(edge.src, edge.dst)) {
+          forest_position[edge.idx] = forest.size();
+          forest.push_back(edge.idx);
+          forest_cost += edge.values[j];
+        } else {
+          non_forest.push_back(edge.idx);
+        }
+      }
+      const int32_t forest_size = forest.size();
+      if (forest_size == 0) {
+        continue;
+      }
+
+      // Root the forest, its vertices are the components of the current solution
+      std::fill(head.begin(), head.end(), -1);
+      next.assign(2 * forest_size, -1);
+      for (int32_t k = 0; k < forest_size; ++k) {
+        const int32_t u = current_union_find.find(edges[forest[k]].src);
+        const int32_t v = current_union_find.find(edges[forest[k]].dst);
+        next[2 * k] = head[u];
+        head[u] = 2 * k;
+        next[2 * k + 1] = head[v];
+        head[v] = 2 * k + 1;
+      }
+      std::fill(tree.begin(), tree.end(), -1);
+      for (int32_t root = 0; root < this->V; ++root) {
+        if (tree[root] != -1 || current_union_find.find(root) != root) continue;
+        tree[root] = root;
+        parent[root] = root;
+        parent_edge[root] = -1;
+        depth[root] = 0;
+        queue.clear();
+        queue.push_back(root);
+        for (std::size_t q = 0; q < queue.size(); ++q) {
+          const int32_t u = queue[q];
+          jump[u] = u;
+          for (int32_t a = head[u]; a != -1; a = next[a]) {
+            const Edge& edge = edges[forest[a / 2]];
+            const int32_t v = current_union_find.find(a % 2 == 0 ? edge.dst : edge.src);
+            if (tree[v] != -1) continue;
+            tree[v] = root;
+            parent[v] = u;
+            parent_edge[v] = edge.idx;
+            depth[v] = depth[u] + 1;
+            queue.push_back(v);
+          }
+        }
+      }
+
+      // Replacement edges: the first non-forest edge covering each forest edge
+      int32_t uncovered = forest_size;
+      for (std::size_t k = 0; k < non_forest.size() && uncovered > 0; ++k) {
+        int32_t u = current_union_find.find(edges[non_forest[k]].src);
+        int32_t v = current_union_find.find(edges[non_forest[k]].dst);
+        if (tree[u] != tree[v]) continue;
+        u = find_jump(u);
+        v = find_jump(v);
+        while (u != v) {
+          if (depth[u] < depth[v]) {
+            std::swap(u, v);
+          }
+          replacement[parent_edge[u]] = non_forest[k];
+          --uncovered;
+          jump[u] = parent[u];
+          u = find_jump(u);
+        }
+      }
+
+      // Bound of each candidate: the cheapest `needed` edges of the forest without it
+      const int64_t last = edges[forest[forest_size - 1]].values[j];
+      const int64_t second_last = forest_size > 1 ? edges[forest[forest_size - 2]].values[j] : 0;
+      for (int i = 0; i < this->E; ++i) {
+        if (current_used_edges[i]) continue;
+        if (!current_union_find.can_unite(edges[i].src, edges[i].dst)) continue;
+        int64_t cost = forest_cost;
+        int32_t size = forest_size;
+        int64_t max_cost = last;
+        if (forest_position[i] != -1) {
+          cost -= edges[i].values[j];
+          size -= 1;
+          max_cost = forest_position[i] == forest_size - 1 ? second_last : last;
+          if (replacement[i] != -1) {
+            const int64_t replacement_cost = edges[replacement[i]].values[j];
+            cost += replacement_cost;
+            size += 1;
+            max_cost = std::max(max_cost, replacement_cost);
+          }
+        }
+        if (size > needed) {
+          cost -= max_cost;
+        }
+        lower_bounds[i * M + j] = cost;
       }
     }
-    return lower_bound;
   }
 
   Solution compute_bound_kruskal_for_m(const int32_t& objective) const {
@@ -354,22 +847,20 @@ class MOMST : public ProblemBase<Solution, Candidate> {
     return sol;
   }
 
-  Solution compute_reference_point(const int32_t& M) const {
-    if (M == 2) {
-      Solution nadir = Solution(M, 0);
-      Solution ideal = Solution(M, 0);
-      for (int i = 0; i < M; i++) {
-        Solution m_solution = compute_bound_kruskal_for_m(i);
-        int32_t other = abs(i - 1);
-        nadir[other] += m_solution[other];
-        ideal[i] = m_solution[i];
-      }
-      return nadir;
-    } else {
-      // TODO: Implement the logic to compute the reference point for M > 2
-      assert(false);
-      return Solution(M, 0);
+  // Nadir estimate from the payoff table: the worst value of each objective
+  // over the trees that are optimal for one objective
+  Solution compute_reference_point() const {
+    std::vector<Solution> payoff(M);
+    parallel_for(M, [&](std::size_t i) {
+      payoff[i] = compute_bound_kruskal_for_m(i);
+    });
+    Solution nadir = Solution(M, std::numeric_limits<int64_t>::min());
+    for (const auto& m_solution : payoff) {
+      for (int j = 0; j < M; j++) {
+        nadir[j] = std::max(nadir[j], m_solution[j]);
+      }
     }
+    return nadir;
   }
 };
 
@@ -1,13 +1,20 @@
 #ifndef PROBLEM_BASE_HPP
 #define PROBLEM_BASE_HPP
 
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <decision_vector.hpp>
 #include <indicator.hpp>
+#include <memory_resource>
+#include <numeric>
 #include <utility>
 #include <vector>
 
 using Solution = std::vector<int64_t>;
 // Overload the << operator for std::vector<int64_t>
-std::ostream& operator<<(std::ostream& os, const Solution& sol) {
+inline std::ostream& operator<<(std::ostream& os, const Solution& sol) {
   os << "Solution: (";
   for (size_t i = 0; i < sol.size(); ++i) {
     os << sol[i];
@@ -21,46 +28,117 @@ std::ostream& operator<<(std::ostream& os, const Solution& sol) {
 
 using Candidate = std::pair<int32_t, int64_t>;
 // Overload the << operator for std::pair<int32_t, int64_t>
-std::ostream& operator<<(std::ostream& os, const Candidate& cand) {
+inline std::ostream& operator<<(std::ostream& os, const Candidate& cand) {
   os << "Candidate: (" << cand.first << ", " << cand.second << ")";
   return os;
 }
 
-template <typename Solution, typename Candidate>
-class ProblemBase {
- public:
-  virtual ~ProblemBase() = default;
+// Interface required by HyperGRASP. Problems are called without virtual
+// dispatch; candidates and local search solutions are written into buffers
+// owned by the solver and reused across iterations. Temporary storage must
+// come from the scratch resource, which is reset at every iteration, and
+// reset() must not allocate. The scratch resource only grows within an
+// iteration, so buffers of the size of the instance needed at every
+// construction step belong in the problem, sized once. Like
+// chooseCandidate, generateCandidates works on the construction state of
+// the problem and its buffers, so it is not const and a problem cannot be
+// shared by concurrent constructions. Every solution handed to the solver comes with
+// its decision vector, so that the archive can be relinked later.
+template <typename Problem, typename Solution, typename Candidate>
+concept MOCOProblem = requires(Problem& problem,
+                               const Problem& const_problem,
+                               const Solution& solution,
+                               const std::vector<Solution>& solution_set,
+                               const HypervolumeIndicator<int64_t, Solution>& hvc_space,
+                               std::vector<Candidate>& candidates,
+                               std::vector<Solution>& other_solutions,
+                               DecisionVector& decisions,
+                               const DecisionVector& const_decisions,
+                               std::vector<DecisionVector>& other_decisions,
+                               std::pmr::memory_resource* scratch,
+                               const double& alpha) {
+  problem.reset();
+  { const_problem.getNondominatedSet() } -> std::convertible_to<const std::vector<Solution>&>;
+  { const_problem.getReferencePoint() } -> std::convertible_to<const Solution&>;
+  problem.generateCandidates(solution, solution_set, hvc_space, candidates, scratch);
+  const_problem.selectCandidates(candidates, alpha);
+  { problem.chooseCandidate(candidates) } -> std::convertible_to<const Solution&>;
+  { const_problem.improveSolution(solution, decisions, solution_set, other_solutions, other_decisions, scratch) } -> std::convertible_to<Solution>;
+  const_problem.relinkSolutions(solution, const_decisions, const_decisions, hvc_space, other_solutions, other_decisions, scratch);
+  const_problem.getDecisions(decisions);
+  { const_problem.emptyDecisions() } -> std::convertible_to<DecisionVector>;
+  { const_problem.emptySolution() } -> std::convertible_to<Solution>;
+  { const_problem.isFeasible(solution) } -> std::convertible_to<bool>;
+};
 
-  virtual void reset() = 0;
-  virtual std::vector<Solution> getNondominatedSet() const = 0;
-  virtual std::vector<int64_t> getReferencePoint() const = 0;
-  virtual std::vector<Candidate> generateCandidates(const Solution& current_solution,
-                                                    const std::vector<Solution>& solution_set,
-                                                    const HypervolumeIndicator<int64_t, Solution>& hvc_space) const = 0;
-  virtual Solution chooseCandidate(const std::vector<Candidate>& selected_candidates) = 0;
-  virtual std::tuple<Solution, std::vector<Solution>> improveSolution(const Solution& current_solution, const std::vector<Solution>& solution_set) const = 0;
-  virtual Solution emptySolution() const = 0;
-  virtual bool isFeasible(const Solution& solution) const = 0;
+// Optional interface: optimize a weighted sum of the objectives, in the sense
+// of the problem, with nonnegative weights. The solution is written to
+// decisions; among equal sums it must be nondominated. order is scratch kept
+// by the caller across calls with nearby weights, so that a problem can
+// re-sort its elements from the previous order (see resort_indices). Must be
+// safe to call from several threads at once. Used by SupportedFront and by
+// the warm start of HyperGRASP.
+template <typename Problem, typename Solution>
+concept WeightedSumProblem = requires(const Problem& const_problem,
+                                      const std::vector<int64_t>& weights,
+                                      DecisionVector& decisions,
+                                      std::vector<int32_t>& order) {
+  { const_problem.solveWeightedSum(weights, decisions, order) } -> std::convertible_to<Solution>;
+};
 
-  std::vector<Candidate> selectCandidates(const std::vector<Candidate>& candidates, const double& alpha) const {
-    int64_t diff = static_cast<int64_t>((candidates[0].second - candidates[candidates.size() - 1].second) * (alpha));
-    int64_t threshold = static_cast<int64_t>(candidates[0].second - diff);
-    std::vector<Candidate> selected_candidates;
-    for (int i = 0; i < (int)candidates.size(); i++) {
-      if (candidates[i].second >= threshold) {
-        selected_candidates.push_back(candidates[i]);
-      } else {
-        break;
+// Sort the indices [0, n) by less, a strict total order. order holds the
+// result of a previous sort with similar keys, or is empty. A nearly sorted
+// order is repaired by insertion sort, which falls back to std::sort once it
+// has moved about n log n indices.
+template <typename Less>
+inline void resort_indices(std::vector<int32_t>& order, const std::size_t n, Less&& less) {
+  if (order.size() != n) {
+    order.resize(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), less);
+    return;
+  }
+  std::size_t budget = n * (std::bit_width(n) + 1);
+  for (std::size_t i = 1; i < n; ++i) {
+    const int32_t current = order[i];
+    std::size_t j = i;
+    for (; j > 0 && less(current, order[j - 1]); --j) {
+      if (budget-- == 0) {
+        order[j] = current;
+        std::sort(order.begin(), order.end(), less);
+        return;
       }
+      order[j] = order[j - 1];
     }
-    return selected_candidates;
+    order[j] = current;
+  }
+}
+
+// Shared helpers for the problems (CRTP). Derived must implement the
+// MOCOProblem interface.
+template <typename Derived, typename Solution, typename Candidate>
+class ProblemBase {
+ public:
+  // Restrict the candidates, in place, to those whose score is within alpha of
+  // the best one. The score range is found in one pass and the restricted
+  // candidate list is extracted with a partition, so no sort is needed.
+  void selectCandidates(std::vector<Candidate>& candidates, const double& alpha) const {
+    const auto [min_it, max_it] = std::minmax_element(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+      return a.second < b.second;
+    });
+    int64_t diff = static_cast<int64_t>((max_it->second - min_it->second) * (alpha));
+    int64_t threshold = static_cast<int64_t>(max_it->second - diff);
+    auto rcl_end = std::partition(candidates.begin(), candidates.end(), [threshold](const Candidate& candidate) {
+      return candidate.second >= threshold;
+    });
+    candidates.erase(rcl_end, candidates.end());
   }
 
   Solution compute_nadir_nset(const std::vector<Solution>& nondominated_set, const bool& is_maximization) const {
     if (nondominated_set.empty()) {
-      return this->getReferencePoint();
+      return derived().getReferencePoint();
     }
-    Solution nadir = this->emptySolution();
+    Solution nadir = derived().emptySolution();
     if (is_maximization) {
       std::fill(nadir.begin(), nadir.end(), std::numeric_limits<int64_t>::max());
     } else {
@@ -77,6 +155,14 @@ class ProblemBase {
     }
     return nadir;
   }
+
+ protected:
+  ~ProblemBase() = default;
+
+ private:
+  const Derived& derived() const {
+    return static_cast<const Derived&>(*this);
+  }
 };
 
 #endif  // PROBLEM_BASE_HPP
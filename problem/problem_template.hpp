@@ -4,51 +4,93 @@
 #include <problem_base.hpp>
 
 template <typename Solution, typename Candidate>
-class ProblemTemplate : public ProblemBase<Solution, Candidate> {
+class ProblemTemplate : public ProblemBase<ProblemTemplate<Solution, Candidate>, Solution, Candidate> {
  public:
   ProblemTemplate() {
     // Initialize any necessary data members here
   }
 
-  void reset() override {
-    // Implement the logic to reset the problem state
+  void reset() {
+    // Implement the logic to reset the problem state, reusing the existing storage
   }
 
-  [[nodiscard]] std::vector<Solution> getNondominatedSet() const override {
+  [[nodiscard]] const std::vector<Solution>& getNondominatedSet() const {
     // Implement the logic to return the nondominated set
-    return std::vector<Solution>();
+    return this->nondominated_set;
   }
 
-  [[nodiscard]] std::vector<int64_t> getReferencePoint() const override {
+  [[nodiscard]] const Solution& getReferencePoint() const {
     // Implement the logic to return the reference point
-    return std::vector<int64_t>();
+    return this->reference_point;
   }
 
-  [[nodiscard]] std::vector<Candidate> generateCandidates(const Solution& current_solution,
-                                                          const HypervolumeIndicator<int64_t, Solution>& hvc_space) const override {
+  void generateCandidates(const Solution& current_solution,
+                          const std::vector<Solution>& solution_set,
+                          const HypervolumeIndicator<int64_t, Solution>& hvc_space,
+                          std::vector<Candidate>& candidates,
+                          std::pmr::memory_resource* scratch) {
     // Implement the logic to generate candidates for the problem
-    return std::vector<Candidate>();
+    // The buffer is reused across calls and must be cleared first
+    candidates.clear();
   }
 
-  [[nodiscard]] Solution chooseCandidate(const std::vector<Candidate>& selected_candidates) override {
+  const Solution& chooseCandidate(const std::vector<Candidate>& selected_candidates) {
     // Implement the logic to choose a candidate for the problem
-    return Solution();
+    // Return the updated current solution
+    return this->current_solution;
   }
 
-  [[nodiscard]] Solution emptySolution() const override {
+  [[nodiscard]] Solution emptySolution() const {
     // Implement the logic to return an empty solution for the problem
     return Solution();
   }
 
-  [[nodiscard]] bool isFeasible(const Solution& solution) const override {
+  [[nodiscard]] DecisionVector emptyDecisions() const {
+    // Implement the logic to return a decision vector with one bit per decision variable
+    return DecisionVector();
+  }
+
+  void getDecisions(DecisionVector& decisions) const {
+    // Implement the logic to write the decisions of the solution being constructed
+  }
+
+  [[nodiscard]] bool isFeasible(const Solution& solution) const {
     // Implement the logic to check if a solution is feasible for the problem
     return true;
   }
 
-  [[nodiscard]] std::tuple<Solution, std::vector<Solution>> improveSolution(const Solution& current_solution, const std::vector<Solution>& solution_set) const override {
+  [[nodiscard]] Solution improveSolution(const Solution& current_solution,
+                                         DecisionVector& decisions,
+                                         const std::vector<Solution>& solution_set,
+                                         std::vector<Solution>& other_solutions,
+                                         std::vector<DecisionVector>& other_decisions,
+                                         std::pmr::memory_resource* scratch) const {
     // Implement the logic to improve a solution for the problem
-    return std::make_tuple(Solution(), std::vector<Solution>());
+    // Temporary containers should allocate from scratch (e.g. std::pmr::vector)
+    // Return the improved solution and update decisions to match it
+    // Write other nondominated solutions found into other_solutions, and their decisions into other_decisions
+    other_solutions.clear();
+    other_decisions.clear();
+    return current_solution;
+  }
+
+  void relinkSolutions(const Solution& from_solution,
+                       const DecisionVector& from_decisions,
+                       const DecisionVector& to_decisions,
+                       const HypervolumeIndicator<int64_t, Solution>& hvc_space,
+                       std::vector<Solution>& relinked_solutions,
+                       std::vector<DecisionVector>& relinked_decisions,
+                       std::pmr::memory_resource* scratch) const {
+    // Implement the logic to walk from one solution to the other (path relinking)
+    // Write the nondominated intermediate solutions into relinked_solutions, and their decisions into relinked_decisions
+    relinked_solutions.clear();
+    relinked_decisions.clear();
   }
+
+ private:
+  std::vector<Solution> nondominated_set;
+  Solution reference_point;
+  Solution current_solution;
 };
 
 #endif  // PROBLEM_TEMPLATE_HPP
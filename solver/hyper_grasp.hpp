@@ -1,84 +1,176 @@
 #ifndef HYPER_GRASP_HPP
 #define HYPER_GRASP_HPP
 
-#include <cstdlib>
+#include <archive_pruning.hpp>
+#include <arena.hpp>
+#include <chrono>
+#include <cmath>
+#include <concepts>
 #include <ctime>
+#include <decision_vector.hpp>
 #include <dominance.hpp>
+#include <functional>
 #include <indicator.hpp>
+#include <memory>
+#include <mutex>
+#include <parallel.hpp>
 #include <problem_base.hpp>
+#include <random.hpp>
+#include <reactive_alpha.hpp>
+#include <snapshot.hpp>
 #include <statistics.hpp>
 #include <stopping_criteria.hpp>
-#include <tuple>
+#include <supported_front.hpp>
 #include <vector>
+#include <work_stealing.hpp>
 
 template <typename Problem, typename Solution, typename Candidate>
+  requires MOCOProblem<Problem, Solution, Candidate>
 class HyperGRASP {
  public:
-  HyperGRASP(Problem& problem, StoppingCriteria& stopping_criteria, double alpha = 0.0, bool local_search = false, bool is_maximization = true)
-      : problem(problem), stopping_criteria(stopping_criteria), alpha(alpha), local_search(local_search), is_maximization(is_maximization) {}
+  // If reactive_alphas is not empty, alpha is ignored and each iteration
+  // samples its alpha from reactive_alphas (reactive GRASP). If
+  // path_relinking is positive, two archive solutions are relinked every
+  // path_relinking iterations. If archive_cap is positive, the archive keeps
+  // at most archive_cap solutions, those with the largest exclusive
+  // hypervolume contributions. If hv_samples is positive, problems with 4 or
+  // more objectives score candidates with contributions estimated from
+  // hv_samples points (see HypervolumeIndicator); the reported hypervolume is
+  // exact. If warm_start is positive and the problem solves weighted sums
+  // (WeightedSumProblem), the archive is seeded with the solutions of
+  // warm_start weighted sums before the first iteration.
+  HyperGRASP(Problem& problem, StoppingCriteria& stopping_criteria, double alpha = 0.0, bool local_search = false, bool is_maximization = true,
+             bool validate = true, std::vector<double> reactive_alphas = {}, int32_t path_relinking = 0, std::size_t archive_cap = 0,
+             std::size_t hv_samples = 0, std::size_t warm_start = 0)
+      : problem(problem),
+        stopping_criteria(stopping_criteria),
+        alpha(alpha),
+        local_search(local_search),
+        is_maximization(is_maximization),
+        validate(validate),
+        reactive(!reactive_alphas.empty()),
+        reactive_alpha(reactive ? reactive_alphas : std::vector<double>{alpha}),
+        path_relinking(path_relinking),
+        archive_cap(archive_cap),
+        hv_samples(hv_samples),
+        warm_start(warm_start) {}
 
+  // Solve with the timestamp as seed
   [[nodiscard]] Statistics<Problem, Solution> solve() {
-    // Set seed with timestamp
-    int64_t seed = std::time(0);
-    // int64_t seed = 1;
-    std::srand(seed);
+    return solve(std::time(0));
+  }
+
+  // The problem is reset at every iteration, so the same (already parsed and
+  // preprocessed) problem can be solved many times, with a HyperGRASP per
+  // alpha/seed. Nothing is printed or written to disk.
+  [[nodiscard]] Statistics<Problem, Solution> solve(int64_t seed) {
+    rng::seed(seed);
 
     // Initialize variables for the algorithm
+    // decisions[i] holds the decision vector of solutions[i]
     std::vector<Solution> solutions;
+    std::vector<DecisionVector> decisions;
     Solution ref_point = problem.getReferencePoint();
     // Solution ref_point = problem.compute_nadir_nset(problem.getNondominatedSet(), is_maximization); // Uncomment this line to use the nadir point as reference
-    HypervolumeIndicator<int64_t, Solution> hvc_space(ref_point, is_maximization);
+    HypervolumeIndicator<int64_t, Solution> hvc_space(ref_point, is_maximization, hv_samples);
+    LeastContributorPruning<int64_t, Solution> pruning(ref_point, is_maximization);
 
     // Initialize variables for statistics
     std::vector<std::tuple<double, int32_t, int64_t>> statistics;
     int64_t iterations = 0, skipped_iterations = 0;
+    CandidateCounters counters;
     auto start_time = std::chrono::high_resolution_clock::now();
     statistics.emplace_back(std::make_tuple(0, 0, 0));
 
+    // Buffers reused across iterations and scratch memory for the problem
+    Arena arena;
+    Solution current_solution = problem.emptySolution();
+    std::vector<Candidate> candidates;
+    std::vector<Solution> other_solutions;
+    DecisionVector current_decisions = problem.emptyDecisions();
+    std::vector<DecisionVector> other_decisions;
+
     // Start the algorithm
+    if (stopping_criteria.needsKnownHypervolume() && !problem.getNondominatedSet().empty()) {
+      stopping_criteria.setKnownHypervolume(HypervolumeIndicator<int64_t, Solution>::compute(ref_point, problem.getNondominatedSet(), is_maximization));
+    }
     stopping_criteria.start();
+    if (warm_start > 0) {
+      warmStart(solutions, decisions, hvc_space);
+      stopping_criteria.update(hvc_space.value());
+    }
     while (!stopping_criteria.shouldStop()) {
       iterations++;
 
+      // Select the alpha of this iteration
+      std::size_t alpha_idx = 0;
+      double iteration_alpha = alpha;
+      if (reactive) {
+        alpha_idx = reactive_alpha.sample();
+        iteration_alpha = reactive_alpha.alpha(alpha_idx);
+      }
+      const int64_t hv_before = hvc_space.value();
+      const double cpu_before = ThreadCpuClock::now();
+
+      arena.reset();
       problem.reset();
-      Solution current_solution = problem.emptySolution();
-      std::vector<Candidate> candidates = problem.generateCandidates(current_solution, solutions, hvc_space);
+      std::fill(current_solution.begin(), current_solution.end(), 0);
+      generateCandidates(problem, current_solution, solutions, hvc_space, candidates, arena, counters);
 
       while (!candidates.empty()) {
-        std::vector<Candidate> selected_candidates = problem.selectCandidates(candidates, alpha);
-        current_solution = problem.chooseCandidate(selected_candidates);
-        candidates = problem.generateCandidates(current_solution, solutions, hvc_space);
+        problem.selectCandidates(candidates, iteration_alpha);
+        current_solution = problem.chooseCandidate(candidates);
+        generateCandidates(problem, current_solution, solutions, hvc_space, candidates, arena, counters);
       }
 
       if (problem.isFeasible(current_solution) &&
           hvc_space.contribution(current_solution) > 0) {
-        std::vector<Solution> other_solutions;
+        other_solutions.clear();
+        other_decisions.clear();
+        problem.getDecisions(current_decisions);
         if (local_search) {
-          auto improvement_results = problem.improveSolution(current_solution, solutions);
-          current_solution = std::get<0>(improvement_results);
-          other_solutions = std::get<1>(improvement_results);
+          current_solution = problem.improveSolution(current_solution, current_decisions, solutions, other_solutions, other_decisions, arena.resource());
         }
         // Remove weakly dominated solutions
-        remove_weakly_dominated(solutions, current_solution, is_maximization);
-        remove_weakly_dominated(solutions, other_solutions, is_maximization);
+        remove_weakly_dominated(solutions, decisions, current_solution, is_maximization);
+        for (const auto& other_solution : other_solutions) {
+          remove_weakly_dominated(solutions, decisions, other_solution, is_maximization);
+        }
         // Add the solutions to the list
         solutions.push_back(current_solution);
+        decisions.push_back(current_decisions);
+        decisions.back().compact();
         for (int i = 0; i < (int)other_solutions.size(); i++) {
           solutions.push_back(other_solutions[i]);
+          decisions.push_back(other_decisions[i]);
+          decisions.back().compact();
         }
-        // Insert the solutions in the hypervolume space
-        hvc_space.insert(current_solution);
-        for (int i = 0; i < (int)other_solutions.size(); i++) {
-          hvc_space.insert(other_solutions[i]);
-        }
+        // Insert the solutions in the hypervolume space as a single batch
+        other_solutions.push_back(current_solution);
+        hvc_space.insert(other_solutions);
       } else {
         skipped_iterations++;
         // Special case (Greedy algorithm)
-        if (alpha == 0.0) {
+        if (alpha == 0.0 && !reactive) {
           break;
         }
       }
 
+      if (reactive) {
+        const double cpu_seconds = ThreadCpuClock::now() - cpu_before;
+        reactive_alpha.update(alpha_idx, hvc_space.value() - hv_before, cpu_seconds);
+      }
+
+      if (path_relinking > 0 && iterations % path_relinking == 0) {
+        relinkArchive(solutions, decisions, hvc_space, arena, other_solutions, other_decisions);
+      }
+
+      // The archive may grow a little past the cap so that pruning is amortized
+      if (archive_cap > 0 && solutions.size() > archive_cap + archive_cap / 16) {
+        pruneArchive(solutions, decisions, hvc_space, pruning);
+      }
+
+      stopping_criteria.update(hvc_space.value());
       stopping_criteria.increment();
       if (stopping_criteria.shouldRetrieve()) {
         statistics.emplace_back(std::make_tuple(stopping_criteria.current(), solutions.size(), hvc_space.value()));
@@ -86,23 +178,460 @@ class HyperGRASP {
       }
     }
 
+    if (archive_cap > 0 && solutions.size() > archive_cap) {
+      pruneArchive(solutions, decisions, hvc_space, pruning);
+    }
     statistics.emplace_back(std::make_tuple(stopping_criteria.current(), solutions.size(), hvc_space.value()));
     auto now = std::chrono::high_resolution_clock::now();
     auto elapsed_time = std::chrono::duration<double>(now - start_time).count();
 
-    if (!valid_solutions(solutions, problem.getNondominatedSet(), is_maximization)) {
+    if (validate && !valid_solutions(solutions, problem.getNondominatedSet(), is_maximization)) {
+      throw std::runtime_error("Invalid solutions!");
+    }
+
+    return Statistics<Problem, Solution>(problem, std::move(solutions), seed, std::move(statistics), elapsed_time, iterations, skipped_iterations, is_maximization, counters,
+                                         std::move(decisions));
+  }
+
+  // Parallel solve on n_threads workers. Each iteration is split into a
+  // construction, a local search and a merge task, scheduled by work stealing
+  // so that workers that finish cheap (e.g. skipped) iterations take over
+  // queued work from busy ones. Every task seeds the random engine from the
+  // seed and its iteration, so it does not matter which worker runs it.
+  // Constructions and local searches read an immutable snapshot of the
+  // archive without locking, and merges, which are serialized, publish a new
+  // snapshot when they change the archive. A task may thus work against a
+  // slightly stale archive; the merge checks its solutions against the
+  // current one.
+  // With deterministic set, iterations run in rounds that read the archive as
+  // it was at the start of the round and are merged in iteration order at the
+  // end of it, so an iteration budget gives the same result for any number of
+  // threads. Otherwise each iteration is merged as soon as it finishes.
+  [[nodiscard]] Statistics<Problem, Solution> solveParallel(int64_t seed, std::size_t n_threads, bool deterministic = false)
+    requires std::copy_constructible<Problem>
+  {
+    std::vector<Solution> solutions;
+    std::vector<DecisionVector> decisions;
+    const Solution ref_point = problem.getReferencePoint();
+    HypervolumeIndicator<int64_t, Solution> hvc_space(ref_point, is_maximization, hv_samples);
+    LeastContributorPruning<int64_t, Solution> pruning(ref_point, is_maximization);
+    std::mutex archive_mutex;  // Serializes the merges, which own solutions, decisions and hvc_space
+    int64_t merged = 0;
+    // Publishing copies the whole archive, so it is batched: after every
+    // n_threads changes, or on the first change after publish_interval
+    int64_t unpublished = 0;
+    auto last_publish = std::chrono::steady_clock::now();
+    Snapshot<ArchiveView> view(std::make_shared<const ArchiveView>(ArchiveView{solutions, hvc_space}));
+
+    std::mutex control_mutex;  // Guards the stopping criteria, the statistics and the reactive alphas
+    std::vector<std::tuple<double, int32_t, int64_t>> statistics;
+    int64_t iterations = 0, skipped_iterations = 0;
+    bool greedy_done = false;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    statistics.emplace_back(std::make_tuple(0, 0, 0));
+
+    WorkStealingScheduler scheduler(n_threads);
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (std::size_t w = 0; w < scheduler.size(); ++w) {
+      workers.push_back(std::make_unique<Worker>(problem));
+    }
+    std::vector<std::shared_ptr<Iteration>> round;  // Finished iterations of the current round
+
+    // Merge a finished iteration into the archive and account for it
+    auto merge = [&](Iteration& it, Worker& worker) {
+      std::shared_ptr<const ArchiveView> previous_view;  // Freed after the locks are released
+      std::lock_guard<std::mutex> archive_lock(archive_mutex);
+      const int64_t hv_before = hvc_space.value();
+      if (it.accepted) {
+        mergeBatch(solutions, decisions, hvc_space, it.solutions, it.decisions);
+      }
+      merged++;
+      if (path_relinking > 0 && merged % path_relinking == 0) {
+        rng::seed(task_seed(seed, it.index, 2));
+        worker.arena.reset();
+        relinkArchive(solutions, decisions, hvc_space, worker.arena, worker.other_solutions, worker.other_decisions);
+      }
+      if (archive_cap > 0 && solutions.size() > archive_cap + archive_cap / 16) {
+        pruneArchive(solutions, decisions, hvc_space, pruning);
+      }
+      // Every change adds or prunes hypervolume. The deterministic mode
+      // publishes once per round.
+      if (!deterministic && hvc_space.value() != hv_before) {
+        unpublished++;
+        const auto now = std::chrono::steady_clock::now();
+        if (unpublished >= static_cast<int64_t>(scheduler.size()) || now - last_publish >= publish_interval) {
+          previous_view = view.publish(std::make_shared<const ArchiveView>(ArchiveView{solutions, hvc_space}));
+          unpublished = 0;
+          last_publish = now;
+        }
+      }
+      std::lock_guard<std::mutex> control_lock(control_mutex);
+      if (!it.accepted) {
+        skipped_iterations++;
+        // Special case (Greedy algorithm)
+        greedy_done = greedy_done || (alpha == 0.0 && !reactive);
+      }
+      if (reactive) {
+        // Timings are not reproducible, the deterministic mode scores the gain per iteration
+        reactive_alpha.update(it.alpha_idx, hvc_space.value() - hv_before, deterministic ? 1.0 : it.cpu_seconds);
+      }
+      stopping_criteria.update(hvc_space.value());
+      if (stopping_criteria.shouldRetrieve()) {
+        statistics.emplace_back(std::make_tuple(stopping_criteria.current(), solutions.size(), hvc_space.value()));
+        stopping_criteria.resetRetrieveCriteria();
+      }
+    };
+
+    // Start a new iteration on worker, unless the run is over
+    std::function<bool(std::size_t)> dispatch = [&](std::size_t w) {
+      auto it = std::make_shared<Iteration>();
+      {
+        std::lock_guard<std::mutex> control_lock(control_mutex);
+        if (greedy_done || stopping_criteria.shouldStop()) {
+          return false;
+        }
+        it->index = iterations++;
+        stopping_criteria.increment();
+        // Sampled here, the probabilities change in merges
+        it->alpha = alpha;
+        if (reactive) {
+          rng::seed(task_seed(seed, it->index, 3));
+          it->alpha_idx = reactive_alpha.sample();
+          it->alpha = reactive_alpha.alpha(it->alpha_idx);
+        }
+      }
+      scheduler.push(w, [&, it](std::size_t runner) {
+        Worker& worker = *workers[runner];
+        construct(*it, worker, *view.load(), seed);
+        if (!deterministic) {
+          dispatch(runner);
+        }
+        // Pushed last, so this worker continues with its own iteration
+        scheduler.push(runner, [&, it](std::size_t runner) {
+          Worker& worker = *workers[runner];
+          if (it->accepted && local_search) {
+            improve(*it, worker, *view.load(), seed);
+          }
+          if (deterministic) {
+            std::lock_guard<std::mutex> control_lock(control_mutex);
+            round.push_back(it);
+          } else {
+            merge(*it, worker);
+          }
+        });
+      });
+      return true;
+    };
+
+    if (stopping_criteria.needsKnownHypervolume() && !problem.getNondominatedSet().empty()) {
+      stopping_criteria.setKnownHypervolume(HypervolumeIndicator<int64_t, Solution>::compute(ref_point, problem.getNondominatedSet(), is_maximization));
+    }
+    stopping_criteria.start();
+    if (warm_start > 0) {
+      rng::seed(seed);
+      warmStart(solutions, decisions, hvc_space);
+      stopping_criteria.update(hvc_space.value());
+      view.publish(std::make_shared<const ArchiveView>(ArchiveView{solutions, hvc_space}));
+    }
+    if (deterministic) {
+      // Rounds of a fixed size, so that the result does not depend on n_threads
+      while (true) {
+        std::size_t started = 0;
+        while (started < deterministic_round && dispatch(started % scheduler.size())) {
+          started++;
+        }
+        if (started == 0) {
+          break;
+        }
+        scheduler.run();
+        std::sort(round.begin(), round.end(), [](const auto& a, const auto& b) {
+          return a->index < b->index;
+        });
+        for (const auto& it : round) {
+          merge(*it, *workers[0]);
+        }
+        round.clear();
+        view.publish(std::make_shared<const ArchiveView>(ArchiveView{solutions, hvc_space}));
+      }
+    } else {
+      for (std::size_t w = 0; w < scheduler.size(); ++w) {
+        dispatch(w);
+      }
+      scheduler.run();
+    }
+
+    if (archive_cap > 0 && solutions.size() > archive_cap) {
+      pruneArchive(solutions, decisions, hvc_space, pruning);
+    }
+    statistics.emplace_back(std::make_tuple(stopping_criteria.current(), solutions.size(), hvc_space.value()));
+    auto elapsed_time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+
+    if (validate && !valid_solutions(solutions, problem.getNondominatedSet(), is_maximization)) {
       throw std::runtime_error("Invalid solutions!");
     }
 
-    return Statistics<Problem, Solution>(problem, solutions, seed, statistics, elapsed_time, iterations, skipped_iterations, is_maximization);
+    CandidateCounters counters;
+    for (const auto& worker : workers) {
+      counters.steps += worker->counters.steps;
+      counters.candidates += worker->counters.candidates;
+      counters.generation_time += worker->counters.generation_time;
+      counters.cache_tests += worker->counters.cache_tests;
+      counters.cache_hits += worker->counters.cache_hits;
+    }
+    return Statistics<Problem, Solution>(problem, std::move(solutions), seed, std::move(statistics), elapsed_time, iterations, skipped_iterations, is_maximization, counters,
+                                         std::move(decisions));
   }
 
  private:
+  // An iteration of the parallel solve, passed from task to task. The
+  // constructed solution comes first, followed by those found by local search.
+  struct Iteration {
+    int64_t index = 0;
+    std::size_t alpha_idx = 0;
+    double alpha = 0.0;
+    bool accepted = false;
+    double cpu_seconds = 0;
+    std::vector<Solution> solutions;
+    std::vector<DecisionVector> decisions;
+  };
+
+  // Archive as seen by the tasks of the parallel solve
+  struct ArchiveView {
+    std::vector<Solution> solutions;
+    HypervolumeIndicator<int64_t, Solution> hvc_space;
+  };
+
+  // Copy of the problem, scratch memory and buffers of a parallel worker
+  struct Worker {
+    explicit Worker(const Problem& problem)
+        : problem(problem), current_solution(this->problem.emptySolution()), current_decisions(this->problem.emptyDecisions()) {}
+
+    Problem problem;
+    Arena arena;
+    Solution current_solution;
+    DecisionVector current_decisions;
+    std::vector<Candidate> candidates;
+    std::vector<Solution> other_solutions;
+    std::vector<DecisionVector> other_decisions;
+    CandidateCounters counters;
+  };
+
+  // Iterations per round of the deterministic parallel solve
+  static constexpr std::size_t deterministic_round = 16;
+  // Longest time a change to the archive waits before being published
+  static constexpr std::chrono::milliseconds publish_interval{10};
+
+  // Seed of a task, from the seed of the run, the iteration and the stage
+  static uint64_t task_seed(int64_t seed, int64_t iteration, int stage) {
+    // splitmix64 finalizer
+    uint64_t x = static_cast<uint64_t>(seed) + 0x9e3779b97f4a7c15ULL * static_cast<uint64_t>(4 * iteration + stage + 1);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  // Construction task: builds a solution on the worker's copy of the problem
+  void construct(Iteration& it, Worker& worker, const ArchiveView& archive, int64_t seed) const {
+    const auto start = std::chrono::steady_clock::now();
+    rng::seed(task_seed(seed, it.index, 0));
+    worker.arena.reset();
+    worker.problem.reset();
+    std::fill(worker.current_solution.begin(), worker.current_solution.end(), 0);
+    generateCandidates(worker.problem, worker.current_solution, archive.solutions, archive.hvc_space, worker.candidates, worker.arena, worker.counters);
+    while (!worker.candidates.empty()) {
+      worker.problem.selectCandidates(worker.candidates, it.alpha);
+      worker.current_solution = worker.problem.chooseCandidate(worker.candidates);
+      generateCandidates(worker.problem, worker.current_solution, archive.solutions, archive.hvc_space, worker.candidates, worker.arena, worker.counters);
+    }
+    it.accepted = worker.problem.isFeasible(worker.current_solution) && archive.hvc_space.contribution(worker.current_solution) > 0;
+    if (it.accepted) {
+      worker.problem.getDecisions(worker.current_decisions);
+      it.solutions.push_back(worker.current_solution);
+      it.decisions.push_back(worker.current_decisions);
+    }
+    it.cpu_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  // Local search task
+  void improve(Iteration& it, Worker& worker, const ArchiveView& archive, int64_t seed) const {
+    const auto start = std::chrono::steady_clock::now();
+    rng::seed(task_seed(seed, it.index, 1));
+    worker.arena.reset();
+    worker.other_solutions.clear();
+    worker.other_decisions.clear();
+    it.solutions[0] = worker.problem.improveSolution(it.solutions[0], it.decisions[0], archive.solutions,
+                                                     worker.other_solutions, worker.other_decisions, worker.arena.resource());
+    for (std::size_t i = 0; i < worker.other_solutions.size(); ++i) {
+      it.solutions.push_back(std::move(worker.other_solutions[i]));
+      it.decisions.push_back(std::move(worker.other_decisions[i]));
+    }
+    it.cpu_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
   Problem& problem;
   StoppingCriteria& stopping_criteria;
   double alpha;
   bool local_search;
   bool is_maximization;
+  bool validate;
+  bool reactive;
+  ReactiveAlpha reactive_alpha;
+  int32_t path_relinking;  // Iterations between path relinking stages (0 disables it)
+  std::size_t archive_cap;  // Maximum archive size (0 means unbounded)
+  std::size_t hv_samples;   // Samples per estimated contribution (0 means exact)
+  std::size_t warm_start;   // Weighted sums solved to seed the archive (0 disables it)
+
+  // Warm start: solve warm_start weighted sums of the objectives, in
+  // parallel, and merge the nondominated solutions into the archive as one
+  // batch. With 2 objectives the weights come from the dichotomic search of
+  // SupportedFront. Otherwise the first M weights are the objectives alone;
+  // they give the range of each objective, which scales the remaining, random
+  // weights so that objectives of different magnitudes count alike.
+  void warmStart(std::vector<Solution>& solutions, std::vector<DecisionVector>& decisions,
+                 HypervolumeIndicator<int64_t, Solution>& hvc_space) const {
+    if constexpr (WeightedSumProblem<Problem, Solution>) {
+      const std::size_t m = problem.getReferencePoint().size();
+      std::vector<Solution> batch;
+      std::vector<DecisionVector> batch_decisions;
+      if (m == 2) {
+        SupportedFront<Problem, Solution>(problem, is_maximization).compute(batch, batch_decisions, warm_start);
+        mergeBatch(solutions, decisions, hvc_space, batch, batch_decisions);
+        return;
+      }
+      const std::size_t n_extremes = std::min(warm_start, m);
+      std::vector<std::vector<int64_t>> weights(warm_start, std::vector<int64_t>(m, 0));
+      std::vector<Solution> seeds(warm_start);
+      std::vector<DecisionVector> seed_decisions(warm_start, problem.emptyDecisions());
+      auto solve_range = [&](const std::size_t first, const std::size_t last) {
+        const Problem& instance = problem;
+        parallel_for(last - first, [&](const std::size_t k) {
+          std::vector<int32_t> order;
+          seeds[first + k] = instance.solveWeightedSum(weights[first + k], seed_decisions[first + k], order);
+        });
+      };
+      for (std::size_t j = 0; j < n_extremes; ++j) {
+        weights[j][j] = 1;
+      }
+      solve_range(0, n_extremes);
+      std::vector<double> range(m, 1.0);
+      for (std::size_t j = 0; j < m; ++j) {
+        int64_t low = seeds[0][j], high = seeds[0][j];
+        for (std::size_t k = 1; k < n_extremes; ++k) {
+          low = std::min<int64_t>(low, seeds[k][j]);
+          high = std::max<int64_t>(high, seeds[k][j]);
+        }
+        range[j] = std::max<double>(1.0, static_cast<double>(high - low));
+      }
+      // Uniform on the simplex, divided by the ranges, largest weight 2^16
+      std::vector<double> lambda(m);
+      for (std::size_t k = n_extremes; k < warm_start; ++k) {
+        double largest = 0.0;
+        for (std::size_t j = 0; j < m; ++j) {
+          lambda[j] = -std::log(1.0 - rng::uniform()) / range[j];
+          largest = std::max(largest, lambda[j]);
+        }
+        for (std::size_t j = 0; j < m; ++j) {
+          weights[k][j] = static_cast<int64_t>(std::llround(65536.0 * lambda[j] / largest));
+        }
+      }
+      solve_range(n_extremes, warm_start);
+
+      // Keep one copy of each nondominated seed
+      for (std::size_t k = 0; k < warm_start; ++k) {
+        if (!is_non_dominated(seeds[k], batch, is_maximization)) continue;
+        remove_weakly_dominated(batch, batch_decisions, seeds[k], is_maximization);
+        batch.push_back(std::move(seeds[k]));
+        batch_decisions.push_back(std::move(seed_decisions[k]));
+      }
+      mergeBatch(solutions, decisions, hvc_space, batch, batch_decisions);
+    }
+  }
+
+  // Keep the archive_cap solutions with the largest exclusive hypervolume
+  // contributions, with their decisions, and rebuild the hypervolume space.
+  // pruning keeps the contributions from one prune of the archive to the next.
+  void pruneArchive(std::vector<Solution>& solutions, std::vector<DecisionVector>& decisions,
+                    HypervolumeIndicator<int64_t, Solution>& hvc_space, LeastContributorPruning<int64_t, Solution>& pruning) const {
+    const std::vector<std::size_t> kept = pruning.keep(solutions, archive_cap);
+    for (std::size_t k = 0; k < kept.size(); ++k) {
+      if (kept[k] != k) {
+        solutions[k] = std::move(solutions[kept[k]]);
+        decisions[k] = std::move(decisions[kept[k]]);
+      }
+    }
+    solutions.resize(kept.size());
+    decisions.resize(kept.size());
+    hvc_space.reset(solutions);
+  }
+
+  // Path relinking stage: relink two random archive solutions and add the
+  // intermediate solutions that increase the hypervolume. relinked_solutions
+  // and relinked_decisions are buffers.
+  void relinkArchive(std::vector<Solution>& solutions, std::vector<DecisionVector>& decisions,
+                     HypervolumeIndicator<int64_t, Solution>& hvc_space, Arena& arena,
+                     std::vector<Solution>& relinked_solutions, std::vector<DecisionVector>& relinked_decisions) const {
+    if (solutions.size() < 2) {
+      return;
+    }
+    // The target is the farthest, in the decision space, of a few random solutions
+    const std::size_t from = rng::index(solutions.size());
+    std::size_t to = from;
+    std::size_t to_distance = 0;
+    for (int k = 0; k < 4; ++k) {
+      const std::size_t candidate = rng::index(solutions.size());
+      const std::size_t distance = DecisionVector::distance(decisions[from], decisions[candidate]);
+      if (distance > to_distance) {
+        to = candidate;
+        to_distance = distance;
+      }
+    }
+    if (to == from) {
+      return;
+    }
+    problem.relinkSolutions(solutions[from], decisions[from], decisions[to], hvc_space,
+                            relinked_solutions, relinked_decisions, arena.resource());
+    mergeBatch(solutions, decisions, hvc_space, relinked_solutions, relinked_decisions);
+  }
+
+  // Add a batch of mutually nondominated solutions to the archive, keeping
+  // those that improve it. The batch is filtered in place.
+  void mergeBatch(std::vector<Solution>& solutions, std::vector<DecisionVector>& decisions,
+                  HypervolumeIndicator<int64_t, Solution>& hvc_space,
+                  std::vector<Solution>& batch_solutions, std::vector<DecisionVector>& batch_decisions) const {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < batch_solutions.size(); ++i) {
+      if (hvc_space.contribution(batch_solutions[i]) <= 0) continue;
+      if (kept != i) {
+        batch_solutions[kept] = std::move(batch_solutions[i]);
+        batch_decisions[kept] = std::move(batch_decisions[i]);
+      }
+      kept++;
+    }
+    batch_solutions.resize(kept);
+    batch_decisions.resize(kept);
+    for (std::size_t i = 0; i < kept; ++i) {
+      remove_weakly_dominated(solutions, decisions, batch_solutions[i], is_maximization);
+      solutions.push_back(batch_solutions[i]);
+      decisions.push_back(batch_decisions[i]);
+      decisions.back().compact();
+    }
+    hvc_space.insert(batch_solutions);
+  }
+
+  // Build the candidate list and account for its size, its cost and the
+  // bounds rejected by the dominator cache
+  static void generateCandidates(Problem& instance, const Solution& current_solution, const std::vector<Solution>& solutions,
+                                 const HypervolumeIndicator<int64_t, Solution>& hvc_space, std::vector<Candidate>& candidates,
+                                 Arena& arena, CandidateCounters& counters) {
+    auto start = std::chrono::steady_clock::now();
+    const DominatorCacheCounters cache_before = dominator_cache_counters();
+    instance.generateCandidates(current_solution, solutions, hvc_space, candidates, arena.resource());
+    counters.generation_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    counters.steps += 1;
+    counters.candidates += candidates.size();
+    counters.cache_tests += dominator_cache_counters().tests - cache_before.tests;
+    counters.cache_hits += dominator_cache_counters().hits - cache_before.hits;
+  }
 };
 
 #endif  // HYPER_GRASP_HPP
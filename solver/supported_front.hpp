@@ -0,0 +1,155 @@
+#ifndef SUPPORTED_FRONT_HPP
+#define SUPPORTED_FRONT_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <decision_vector.hpp>
+#include <dominance.hpp>
+#include <indicator.hpp>
+#include <memory>
+#include <parallel.hpp>
+#include <problem_base.hpp>
+#include <stdexcept>
+#include <statistics.hpp>
+#include <vector>
+
+// Supported solutions of a bi-objective problem by dichotomic search
+// (Aneja-Nair): starting from the optima of each objective, the weighted sum
+// normal to the segment between two adjacent supported points either finds a
+// new point beyond the segment, which splits it in two, or proves that there
+// is none. With exact weighted sums every extreme supported point is found
+// with at most 2 * |front| - 1 of them. The segments of a level are solved in
+// parallel, each one starting from the sorted order of the weighted sum that
+// created it.
+template <typename Problem, typename Solution>
+  requires WeightedSumProblem<Problem, Solution>
+class SupportedFront {
+ public:
+  explicit SupportedFront(const Problem& problem, bool is_maximization = true)
+      : problem(problem), is_maximization(is_maximization) {}
+
+  // Standalone run: the supported front with the statistics of a solve, the
+  // iterations being the weighted sums
+  [[nodiscard]] Statistics<Problem, Solution> solve() const {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<Solution> solutions;
+    std::vector<DecisionVector> decisions;
+    const std::size_t sums = compute(solutions, decisions);
+    for (auto& decision : decisions) {
+      decision.compact();
+    }
+    const int64_t hv = HypervolumeIndicator<int64_t, Solution>::compute(problem.getReferencePoint(), solutions, is_maximization);
+    std::vector<std::tuple<double, int32_t, int64_t>> statistics;
+    statistics.emplace_back(std::make_tuple(0, 0, 0));
+    statistics.emplace_back(std::make_tuple(static_cast<double>(sums), static_cast<int32_t>(solutions.size()), hv));
+    auto elapsed_time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+    return Statistics<Problem, Solution>(problem, std::move(solutions), 0, std::move(statistics), elapsed_time, sums, 0,
+                                         is_maximization, CandidateCounters{}, std::move(decisions));
+  }
+
+  // Append the supported solutions found with at most max_sums weighted sums
+  // (0 means no limit) to solutions and decisions, keeping one copy of each
+  // nondominated one (heuristic weighted sums may find dominated ones).
+  // Returns the number of weighted sums solved.
+  std::size_t compute(std::vector<Solution>& solutions, std::vector<DecisionVector>& decisions, std::size_t max_sums = 0) const {
+    if (problem.getReferencePoint().size() != 2) {
+      throw std::invalid_argument("The dichotomic search needs 2 objectives");
+    }
+    if (max_sums == 0) {
+      max_sums = static_cast<std::size_t>(-1);
+    }
+    std::vector<Task> tasks(std::min<std::size_t>(2, max_sums));
+    tasks[0].weights = {1, 0};
+    if (tasks.size() > 1) {
+      tasks[1].weights = {0, 1};
+    }
+    run(tasks);
+    std::size_t sums = tasks.size();
+    std::vector<Solution> found;
+    std::vector<DecisionVector> found_decisions;
+    keep(found, found_decisions, tasks[0]);
+    if (tasks.size() < 2 || tasks[1].solution == tasks[0].solution) {
+      append(solutions, decisions, found, found_decisions);
+      return sums;
+    }
+    keep(found, found_decisions, tasks[1]);
+
+    // Segments between adjacent points, the best one in objective 0 first
+    std::vector<Segment> level = {Segment{tasks[0].solution, tasks[1].solution, std::make_shared<const std::vector<int32_t>>(tasks[1].order)}};
+    while (!level.empty() && sums < max_sums) {
+      level.resize(std::min(level.size(), max_sums - sums));
+      tasks.assign(level.size(), Task{});
+      for (std::size_t k = 0; k < level.size(); ++k) {
+        // Normal to the segment, both components positive
+        tasks[k].weights = {std::abs(level[k].first[1] - level[k].second[1]), std::abs(level[k].first[0] - level[k].second[0])};
+        tasks[k].order = *level[k].order;
+      }
+      run(tasks);
+      sums += tasks.size();
+      std::vector<Segment> next;
+      for (std::size_t k = 0; k < tasks.size(); ++k) {
+        if (!beyond(tasks[k].weights, tasks[k].solution, level[k].first)) continue;
+        auto order = std::make_shared<const std::vector<int32_t>>(tasks[k].order);
+        next.push_back(Segment{level[k].first, tasks[k].solution, order});
+        next.push_back(Segment{tasks[k].solution, level[k].second, order});
+        keep(found, found_decisions, tasks[k]);
+      }
+      level = std::move(next);
+    }
+    append(solutions, decisions, found, found_decisions);
+    return sums;
+  }
+
+ private:
+  struct Task {
+    std::vector<int64_t> weights;
+    Solution solution;
+    DecisionVector decisions;
+    std::vector<int32_t> order;
+  };
+
+  struct Segment {
+    Solution first;
+    Solution second;
+    std::shared_ptr<const std::vector<int32_t>> order;  // Of the weighted sum that found second (or first)
+  };
+
+  const Problem& problem;
+  bool is_maximization;
+
+  void run(std::vector<Task>& tasks) const {
+    for (auto& task : tasks) {
+      task.decisions = problem.emptyDecisions();
+    }
+    parallel_for(tasks.size(), [&](const std::size_t k) {
+      tasks[k].solution = problem.solveWeightedSum(tasks[k].weights, tasks[k].decisions, tasks[k].order);
+    });
+  }
+
+  // True if the weighted sum of sol is strictly better than that of point
+  [[nodiscard]] bool beyond(const std::vector<int64_t>& weights, const Solution& sol, const Solution& point) const {
+    const int64_t gain = weights[0] * (sol[0] - point[0]) + weights[1] * (sol[1] - point[1]);
+    return is_maximization ? gain > 0 : gain < 0;
+  }
+
+  // Add the solution of task to the found ones if none weakly dominates it
+  void keep(std::vector<Solution>& found, std::vector<DecisionVector>& found_decisions, Task& task) const {
+    if (!is_non_dominated(task.solution, found, is_maximization)) {
+      return;
+    }
+    remove_weakly_dominated(found, found_decisions, task.solution, is_maximization);
+    found.push_back(task.solution);
+    found_decisions.push_back(std::move(task.decisions));
+  }
+
+  static void append(std::vector<Solution>& solutions, std::vector<DecisionVector>& decisions,
+                     std::vector<Solution>& found, std::vector<DecisionVector>& found_decisions) {
+    for (std::size_t i = 0; i < found.size(); ++i) {
+      solutions.push_back(std::move(found[i]));
+      decisions.push_back(std::move(found_decisions[i]));
+    }
+  }
+};
+
+#endif  // SUPPORTED_FRONT_HPP